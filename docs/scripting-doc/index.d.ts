@@ -2331,6 +2331,20 @@ interface TileLayerEdit {
    */
   setTile(x : number, y : number, tile : Tile | null, flags? : number) : void
 
+  /**
+   * Fills the given region with tiles from the given Wang set, matching the
+   * tiles currently in the target layer around the region. Large regions
+   * are filled using multiple threads.
+   *
+   * When a `seed` is given, the same tiles are chosen each time for the
+   * same input.
+   *
+   * The target layer needs to be part of a map.
+   *
+   * @since 1.8
+   */
+  wangFill(region : region, wangSet : WangSet, seed? : number) : void
+
   /**
    * Applies all changes made through this object. This object can be reused to make further changes.
    */
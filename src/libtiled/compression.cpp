@@ -231,3 +231,224 @@ QByteArray Tiled::compress(const QByteArray &data,
         return QByteArray();
     }
 }
+
+namespace Tiled {
+
+class DecompressorPrivate
+{
+public:
+    // The maximum amount of decompressed data passed to the output at once
+    static constexpr int BlockSize = 16384;
+
+    DecompressorPrivate(CompressionMethod method, Decompressor::Output output);
+    ~DecompressorPrivate();
+
+    bool write(const char *data, int length);
+    bool finish();
+
+private:
+    bool writeZlib(const char *data, int length);
+#ifdef TILED_ZSTD_SUPPORT
+    bool writeZstd(const char *data, int length);
+#endif
+
+    const CompressionMethod mMethod;
+    const Decompressor::Output mOutput;
+    QByteArray mBuffer;
+    bool mFailed = false;
+    bool mStreamEnded = false;
+    qint64 mInputSize = 0;
+
+    z_stream mZlibStream;
+#ifdef TILED_ZSTD_SUPPORT
+    ZSTD_DStream *mZstdStream = nullptr;
+#endif
+};
+
+} // namespace Tiled
+
+DecompressorPrivate::DecompressorPrivate(CompressionMethod method,
+                                         Decompressor::Output output)
+    : mMethod(method)
+    , mOutput(std::move(output))
+{
+    mBuffer.resize(BlockSize);
+
+    if (method == Zlib || method == Gzip) {
+        mZlibStream.zalloc = Z_NULL;
+        mZlibStream.zfree = Z_NULL;
+        mZlibStream.opaque = Z_NULL;
+        mZlibStream.next_in = Z_NULL;
+        mZlibStream.avail_in = 0;
+
+        const int ret = inflateInit2(&mZlibStream, 15 + 32);
+        if (ret != Z_OK) {
+            logZlibError(ret);
+            mFailed = true;
+        }
+#ifdef TILED_ZSTD_SUPPORT
+    } else if (method == Zstandard) {
+        mZstdStream = ZSTD_createDStream();
+        const size_t ret = ZSTD_initDStream(mZstdStream);
+        if (ZSTD_isError(ret)) {
+            qDebug() << "error decoding:" << ZSTD_getErrorName(ret);
+            mFailed = true;
+        }
+#endif
+    } else {
+        qDebug() << "compression not supported:" << method;
+        mFailed = true;
+    }
+}
+
+DecompressorPrivate::~DecompressorPrivate()
+{
+    if (mMethod == Zlib || mMethod == Gzip) {
+        inflateEnd(&mZlibStream);
+#ifdef TILED_ZSTD_SUPPORT
+    } else if (mMethod == Zstandard) {
+        ZSTD_freeDStream(mZstdStream);
+#endif
+    }
+}
+
+bool DecompressorPrivate::write(const char *data, int length)
+{
+    if (mFailed)
+        return false;
+    if (length == 0)
+        return true;
+
+    mInputSize += length;
+
+#ifdef TILED_ZSTD_SUPPORT
+    if (mMethod == Zstandard)
+        mFailed = !writeZstd(data, length);
+    else
+#endif
+        mFailed = !writeZlib(data, length);
+
+    return !mFailed;
+}
+
+bool DecompressorPrivate::writeZlib(const char *data, int length)
+{
+    if (mStreamEnded) {
+        // Unexpected data after the end of the compressed stream
+        logZlibError(Z_DATA_ERROR);
+        return false;
+    }
+
+    mZlibStream.next_in = (Bytef *) data;
+    mZlibStream.avail_in = length;
+
+    do {
+        mZlibStream.next_out = (Bytef *) mBuffer.data();
+        mZlibStream.avail_out = BlockSize;
+
+        int ret = inflate(&mZlibStream, Z_NO_FLUSH);
+        Q_ASSERT(ret != Z_STREAM_ERROR);
+
+        switch (ret) {
+            case Z_NEED_DICT:
+                ret = Z_DATA_ERROR;
+                Q_FALLTHROUGH();
+            case Z_DATA_ERROR:
+            case Z_MEM_ERROR:
+                logZlibError(ret);
+                return false;
+        }
+
+        const int produced = BlockSize - mZlibStream.avail_out;
+        if (produced > 0 && !mOutput(mBuffer.constData(), produced))
+            return false;
+
+        if (ret == Z_STREAM_END) {
+            mStreamEnded = true;
+
+            if (mZlibStream.avail_in != 0) {
+                logZlibError(Z_DATA_ERROR);
+                return false;
+            }
+            break;
+        }
+    } while (mZlibStream.avail_in > 0 || mZlibStream.avail_out == 0);
+
+    return true;
+}
+
+#ifdef TILED_ZSTD_SUPPORT
+bool DecompressorPrivate::writeZstd(const char *data, int length)
+{
+    ZSTD_inBuffer in = { data, static_cast<size_t>(length), 0 };
+    bool outputFull;
+
+    do {
+        ZSTD_outBuffer out = { mBuffer.data(), BlockSize, 0 };
+
+        const size_t ret = ZSTD_decompressStream(mZstdStream, &out, &in);
+        if (ZSTD_isError(ret)) {
+            qDebug() << "error decoding:" << ZSTD_getErrorName(ret);
+            return false;
+        }
+
+        // A return value of 0 means a frame was completely decoded
+        mStreamEnded = ret == 0;
+
+        if (out.pos > 0 && !mOutput(mBuffer.constData(), static_cast<int>(out.pos)))
+            return false;
+
+        outputFull = out.pos == out.size;
+    } while (in.pos < in.size || outputFull);
+
+    return true;
+}
+#endif
+
+bool DecompressorPrivate::finish()
+{
+    if (mFailed)
+        return false;
+
+    // Like decompress(), accept empty input as empty output
+    if (mInputSize == 0)
+        return true;
+
+    if (!mStreamEnded) {
+        qDebug() << "Unexpected end of compressed data!";
+        mFailed = true;
+    }
+
+    return !mFailed;
+}
+
+
+/**
+ * Creates a decompressor for the given compression \a method, which passes
+ * the decompressed data on to \a output.
+ */
+Decompressor::Decompressor(CompressionMethod method, Output output)
+    : d(new DecompressorPrivate(method, std::move(output)))
+{
+}
+
+Decompressor::~Decompressor() = default;
+
+/**
+ * Decompresses the given \a data, passing any decompressed data to the
+ * output function. Returns false when an error occurred or when the output
+ * function requested to stop.
+ */
+bool Decompressor::write(const char *data, int length)
+{
+    return d->write(data, length);
+}
+
+/**
+ * Should be called after all data has been written. Returns whether the
+ * compressed stream was complete and no errors occurred.
+ */
+bool Decompressor::finish()
+{
+    return d->finish();
+}
@@ -30,10 +30,15 @@
 
 #include "tiled_global.h"
 
+#include <functional>
+#include <memory>
+
 class QByteArray;
 
 namespace Tiled {
 
+class DecompressorPrivate;
+
 enum CompressionMethod {
     Gzip,
     Zlib,
@@ -69,4 +74,31 @@ QByteArray TILEDSHARED_EXPORT compress(const QByteArray &data,
                                        CompressionMethod method,
                                        int compressionLevel = -1);
 
+/**
+ * Decompresses zlib, gzip or zstd compressed data incrementally. The input
+ * can be passed in pieces of any size and the decompressed data is passed on
+ * to the output function in blocks of limited size, so that the uncompressed
+ * data never needs to be held in memory as a whole.
+ */
+class TILEDSHARED_EXPORT Decompressor
+{
+public:
+    /**
+     * Receives the decompressed data. Can return false to abort
+     * decompression.
+     */
+    using Output = std::function<bool (const char *data, int length)>;
+
+    Decompressor(CompressionMethod method, Output output);
+    ~Decompressor();
+
+    bool write(const char *data, int length);
+    bool finish();
+
+private:
+    Q_DISABLE_COPY(Decompressor)
+
+    std::unique_ptr<DecompressorPrivate> d;
+};
+
 } // namespace Tiled
@@ -0,0 +1,132 @@
+/*
+ * csvparser.h
+ * Copyright 2026, agent <agent@local>
+ *
+ * This file is part of libtiled.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *    1. Redistributions of source code must retain the above copyright notice,
+ *       this list of conditions and the following disclaimer.
+ *
+ *    2. Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE CONTRIBUTORS ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO
+ * EVENT SHALL THE CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+ * ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#pragma once
+
+#include "tiled_global.h"
+
+#include <QChar>
+
+namespace Tiled {
+
+/**
+ * A fast parser for comma-separated lists of unsigned integers, as used by
+ * the CSV layer data format.
+ *
+ * Works directly on either 8-bit (Latin-1 or UTF-8) or 16-bit (QChar) text,
+ * so that the data doesn't need to be converted first. Whitespace is ignored
+ * and empty values are read as 0.
+ */
+template <typename Char>
+class CsvParser
+{
+public:
+    enum Error {
+        NoError,
+        UnexpectedEnd,
+        UnexpectedCharacter
+    };
+
+    CsvParser(const Char *begin, const Char *end)
+        : mPos(begin)
+        , mEnd(end)
+    {}
+
+    int read(unsigned *values, int count);
+
+    /**
+     * Returns whether all text has been consumed.
+     */
+    bool atEnd() const { return mPos == mEnd; }
+
+    Error error() const { return mError; }
+
+    /**
+     * Returns the character that caused the UnexpectedCharacter error.
+     */
+    QChar errorCharacter() const { return QChar(mErrorCharacter); }
+
+private:
+    static ushort charCode(char c) { return static_cast<uchar>(c); }
+    static ushort charCode(QChar c) { return c.unicode(); }
+
+    static bool isSpace(ushort c)
+    {
+        if (c < 128)
+            return c == ' ' || (c >= '\t' && c <= '\r');
+        return QChar::isSpace(c);
+    }
+
+    const Char *mPos;
+    const Char *mEnd;
+    Error mError = NoError;
+    ushort mErrorCharacter = 0;
+};
+
+/**
+ * Reads up to \a count values into \a values. Returns the number of values
+ * that were read, which is less than \a count when an error occurred.
+ */
+template <typename Char>
+inline int CsvParser<Char>::read(unsigned *values, int count)
+{
+    const Char *pos = mPos;
+    int parsed = 0;
+
+    for (; parsed < count; ++parsed) {
+        if (pos == mEnd) {
+            mError = UnexpectedEnd;
+            break;
+        }
+
+        unsigned value = 0;
+
+        while (pos != mEnd) {
+            const ushort c = charCode(*pos++);
+            const unsigned digit = c - '0';
+
+            if (digit < 10) {
+                value = value * 10 + digit;
+            } else if (c == ',') {
+                break;
+            } else if (!isSpace(c)) {
+                mError = UnexpectedCharacter;
+                mErrorCharacter = c;
+                mPos = pos;
+                return parsed;
+            }
+        }
+
+        values[parsed] = value;
+    }
+
+    mPos = pos;
+    return parsed;
+}
+
+} // namespace Tiled
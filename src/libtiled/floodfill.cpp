@@ -0,0 +1,268 @@
+/*
+ * floodfill.cpp
+ * Copyright 2026, agent <agent@local>
+ *
+ * This file is part of libtiled.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *    1. Redistributions of source code must retain the above copyright notice,
+ *       this list of conditions and the following disclaimer.
+ *
+ *    2. Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE CONTRIBUTORS ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO
+ * EVENT SHALL THE CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+ * ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "floodfill.h"
+
+#include <QtConcurrent/QtConcurrentMap>
+
+#include <vector>
+
+using namespace Tiled;
+
+namespace {
+
+/**
+ * A bit mask covering a rectangle, with each row stored as contiguous words.
+ */
+class FillMask
+{
+public:
+    explicit FillMask(const QRect &rect)
+        : mRect(rect)
+        , mWordsPerRow((rect.width() + 63) / 64)
+        , mWords(static_cast<size_t>(mWordsPerRow) * rect.height())
+    {}
+
+    bool test(int x, int y) const
+    {
+        const int index = x - mRect.left();
+        return mWords[wordIndex(index, y)] & (quint64(1) << (index & 63));
+    }
+
+    void set(int x, int y)
+    {
+        const int index = x - mRect.left();
+        mWords[wordIndex(index, y)] |= quint64(1) << (index & 63);
+    }
+
+    TileRegion toTileRegion() const
+    {
+        TileRegion region;
+        for (int y = mRect.top(); y <= mRect.bottom(); ++y)
+            for (int word = 0; word < mWordsPerRow; ++word)
+                if (const quint64 bits = mWords[wordIndex(word * 64, y)])
+                    region.addRow(mRect.left() + word * 64, y, bits);
+        return region;
+    }
+
+private:
+    size_t wordIndex(int index, int y) const
+    {
+        return static_cast<size_t>(y - mRect.top()) * mWordsPerRow + (index >> 6);
+    }
+
+    QRect mRect;
+    int mWordsPerRow;
+    std::vector<quint64> mWords;
+};
+
+} // anonymous namespace
+
+FloodFillParameters::FloodFillParameters(const TileLayer &tileLayer)
+    : chunks(tileLayer.chunks())
+    , layerPosition(tileLayer.position())
+{
+    if (const Map *map = tileLayer.map()) {
+        orientation = map->orientation();
+        staggerAxis = map->staggerAxis();
+        staggerIndex = map->staggerIndex();
+    }
+}
+
+/**
+ * Computes the region of connected cells that are equal to the one at
+ * \a fillOrigin, within the bounding rect of \a region. Works in layer
+ * coordinates.
+ *
+ * The matching cells are first marked in a bit mask, processing each row of
+ * chunks in parallel, after which a scanline fill runs on the bit mask.
+ *
+ * Returns an empty region when \a canceled gets set.
+ */
+TileRegion Tiled::floodFill(const FloodFillParameters &parameters,
+                            const QRegion &region,
+                            QPoint fillOrigin,
+                            const std::atomic_bool *canceled)
+{
+    // Return empty region when the bounds do not contain the fill origin
+    if (!region.contains(fillOrigin))
+        return TileRegion();
+
+    const QHash<QPoint, Chunk> &chunks = parameters.chunks;
+    auto findChunk = [&chunks] (int x, int y) -> const Chunk * {
+        auto it = chunks.find(QPoint(x >> CHUNK_BITS, y >> CHUNK_BITS));
+        return it != chunks.end() ? &it.value() : nullptr;
+    };
+    auto isCanceled = [canceled] {
+        return canceled && canceled->load(std::memory_order_relaxed);
+    };
+
+    // Cache cell that we will match other cells against
+    const Chunk *originChunk = findChunk(fillOrigin.x(), fillOrigin.y());
+    const Cell matchCell = originChunk ? originChunk->cellAt(fillOrigin.x() & CHUNK_MASK,
+                                                             fillOrigin.y() & CHUNK_MASK)
+                                       : Cell::empty;
+    const bool missingChunksMatch = matchCell == Cell::empty;
+
+    const QRect bounds = region.boundingRect();
+
+    // Mark the matching cells. Each row of chunks covers its own rows of
+    // the mask, so they can be processed in parallel.
+    FillMask matching(bounds);
+
+    QVector<int> chunkRows;
+    for (int chunkY = bounds.top() >> CHUNK_BITS; chunkY <= bounds.bottom() >> CHUNK_BITS; ++chunkY)
+        chunkRows.append(chunkY);
+
+    QtConcurrent::blockingMap(chunkRows, [&] (int chunkY) {
+        if (isCanceled())
+            return;
+
+        const int top = qMax(chunkY * CHUNK_SIZE, bounds.top());
+        const int bottom = qMin(chunkY * CHUNK_SIZE + CHUNK_MASK, bounds.bottom());
+
+        for (int chunkX = bounds.left() >> CHUNK_BITS; chunkX <= bounds.right() >> CHUNK_BITS; ++chunkX) {
+            const int left = qMax(chunkX * CHUNK_SIZE, bounds.left());
+            const int right = qMin(chunkX * CHUNK_SIZE + CHUNK_MASK, bounds.right());
+            const Chunk *chunk = findChunk(left, top);
+
+            if (!chunk && !missingChunksMatch)
+                continue;
+
+            for (int y = top; y <= bottom; ++y)
+                for (int x = left; x <= right; ++x)
+                    if (!chunk || chunk->cellAt(x & CHUNK_MASK, y & CHUNK_MASK) == matchCell)
+                        matching.set(x, y);
+        }
+    });
+
+    const int layerX = parameters.layerPosition.x();
+    const int layerY = parameters.layerPosition.y();
+    const Map::StaggerAxis staggerAxis = parameters.staggerAxis;
+    const Map::StaggerIndex staggerIndex = parameters.staggerIndex;
+    const bool isStaggered = parameters.orientation == Map::Hexagonal ||
+            parameters.orientation == Map::Staggered;
+
+    FillMask filled(bounds);
+
+    // Create a stack to hold cells that need filling
+    QVector<QPoint> fillPositions;
+    fillPositions.append(fillOrigin);
+
+    // Loop through queued positions and fill them, while at the same time
+    // checking adjacent positions to see if they should be added
+    while (!fillPositions.isEmpty()) {
+        if (isCanceled())
+            return TileRegion();
+
+        const QPoint currentPoint = fillPositions.takeLast();
+        const int y = currentPoint.y();
+
+        // Already filled as part of the span of another position
+        if (filled.test(currentPoint.x(), y))
+            continue;
+
+        // Seek as far left as we can
+        int left = currentPoint.x();
+        while (left > bounds.left() && matching.test(left - 1, y))
+            --left;
+
+        // Seek as far right as we can
+        int right = currentPoint.x();
+        while (right < bounds.right() && matching.test(right + 1, y))
+            ++right;
+
+        for (int x = left; x <= right; ++x)
+            filled.set(x, y);
+
+        bool leftColumnIsStaggered = false;
+        bool rightColumnIsStaggered = false;
+
+        // For hexagonal maps with a staggered Y-axis, we may need to extend the search range
+        if (isStaggered) {
+            if (staggerAxis == Map::StaggerY) {
+                bool rowIsStaggered = ((layerY + y) & 1) ^ staggerIndex;
+                if (rowIsStaggered)
+                    right = qMin(right + 1, bounds.right());
+                else
+                    left = qMax(left - 1, bounds.left());
+            } else {
+                leftColumnIsStaggered = ((layerX + left) & 1) ^ staggerIndex;
+                rightColumnIsStaggered = ((layerX + right) & 1) ^ staggerIndex;
+            }
+        }
+
+        // Loop between left and right and check if cells above or below need
+        // to be added to the stack.
+        auto findFillPositions = [&] (int left, int right, int y) {
+            bool adjacentCellAdded = false;
+
+            for (int x = left; x <= right; ++x) {
+                if (matching.test(x, y) && !filled.test(x, y)) {
+                    // Do not add the cell to the stack if an adjacent cell was added.
+                    if (!adjacentCellAdded) {
+                        fillPositions.append(QPoint(x, y));
+                        adjacentCellAdded = true;
+                    }
+                } else {
+                    adjacentCellAdded = false;
+                }
+            }
+        };
+
+        if (y > bounds.top()) {
+            int _left = left;
+            int _right = right;
+
+            if (isStaggered && staggerAxis == Map::StaggerX) {
+                if (!leftColumnIsStaggered)
+                    _left = qMax(left - 1, bounds.left());
+                if (!rightColumnIsStaggered)
+                    _right = qMin(right + 1, bounds.right());
+            }
+
+            findFillPositions(_left, _right, y - 1);
+        }
+
+        if (y < bounds.bottom()) {
+            int _left = left;
+            int _right = right;
+
+            if (isStaggered && staggerAxis == Map::StaggerX) {
+                if (leftColumnIsStaggered)
+                    _left = qMax(left - 1, bounds.left());
+                if (rightColumnIsStaggered)
+                    _right = qMin(right + 1, bounds.right());
+            }
+
+            findFillPositions(_left, _right, y + 1);
+        }
+    }
+
+    return filled.toTileRegion();
+}
@@ -0,0 +1,64 @@
+/*
+ * floodfill.h
+ * Copyright 2026, agent <agent@local>
+ *
+ * This file is part of libtiled.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *    1. Redistributions of source code must retain the above copyright notice,
+ *       this list of conditions and the following disclaimer.
+ *
+ *    2. Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE CONTRIBUTORS ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO
+ * EVENT SHALL THE CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+ * ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#pragma once
+
+#include "map.h"
+#include "tilelayer.h"
+#include "tileregion.h"
+
+#include <QHash>
+#include <QPoint>
+#include <QRegion>
+
+#include <atomic>
+
+namespace Tiled {
+
+/**
+ * The data needed to flood fill a tile layer. It is copied from the layer,
+ * so that the fill can run on a worker thread.
+ */
+struct TILEDSHARED_EXPORT FloodFillParameters
+{
+    FloodFillParameters() = default;
+    explicit FloodFillParameters(const TileLayer &tileLayer);
+
+    QHash<QPoint, Chunk> chunks;    // implicitly shared with the layer
+    QPoint layerPosition;
+    Map::Orientation orientation = Map::Orthogonal;
+    Map::StaggerAxis staggerAxis = Map::StaggerY;
+    Map::StaggerIndex staggerIndex = Map::StaggerOdd;
+};
+
+TILEDSHARED_EXPORT TileRegion floodFill(const FloodFillParameters &parameters,
+                                        const QRegion &region,
+                                        QPoint fillOrigin,
+                                        const std::atomic_bool *canceled = nullptr);
+
+} // namespace Tiled
@@ -33,7 +33,12 @@
 #include "tiled.h"
 #include "tileset.h"
 
+#include <QtConcurrent/QtConcurrentMap>
+#include <QtEndian>
+
 #include <algorithm>
+#include <limits>
+#include <memory>
 
 using namespace Tiled;
 
@@ -44,6 +49,9 @@ const unsigned FlippedAntiDiagonallyFlag = 0x20000000;
 
 const unsigned RotatedHexagonal120Flag   = 0x10000000;
 
+// The amount of base64 decoded data passed on for decompression at once
+static const int DecodeBlockSize = 16384;
+
 /**
  * Default constructor. Use \l insert to initialize the gid mapper
  * incrementally.
@@ -65,6 +73,37 @@ GidMapper::GidMapper(const QVector<SharedTileset> &tilesets)
     }
 }
 
+/**
+ * Insert the given \a tileset with \a firstGid as its first global ID.
+ */
+void GidMapper::insert(unsigned firstGid, const SharedTileset &tileset)
+{
+    auto existing = mFirstGidToTileset.find(firstGid);
+    if (existing != mFirstGidToTileset.end() && existing.value() != tileset) {
+        // Replacing the tileset at this first GID, so the reverse lookup for
+        // the previous tileset needs to be rebuilt.
+        existing.value() = tileset;
+        resetCachedRange();
+
+        mTilesetToFirstGid.clear();
+        for (auto it = mFirstGidToTileset.cbegin(); it != mFirstGidToTileset.cend(); ++it)
+            if (!mTilesetToFirstGid.contains(it.value().data()))
+                mTilesetToFirstGid.insert(it.value().data(), it.key());
+        return;
+    }
+
+    mFirstGidToTileset.insert(firstGid, tileset);
+    resetCachedRange();
+
+    // When a tileset is inserted multiple times, the lowest first GID is used
+    // for writing, since that's the one a linear search would find first.
+    auto it = mTilesetToFirstGid.find(tileset.data());
+    if (it == mTilesetToFirstGid.end())
+        mTilesetToFirstGid.insert(tileset.data(), firstGid);
+    else if (firstGid < it.value())
+        it.value() = firstGid;
+}
+
 /**
  * Returns the cell data matched by the given \a gid. The \a ok parameter
  * indicates whether an error occurred.
@@ -72,13 +111,27 @@ GidMapper::GidMapper(const QVector<SharedTileset> &tilesets)
 Cell GidMapper::gidToCell(unsigned gid, bool &ok) const
 {
     Cell result;
+    ok = decodeCell(gid, result);
+    return result;
+}
+
+/**
+ * Sets \a cell to the cell data matched by the given \a gid. Returns whether
+ * the gid could be resolved.
+ *
+ * The GID range of the last found tileset is remembered, so that consecutive
+ * GIDs referring to the same tileset do not need to look it up again.
+ */
+bool GidMapper::decodeCell(unsigned gid, Cell &cell) const
+{
+    cell = Cell();
 
     // Read out the flags
-    result.setFlippedHorizontally(gid & FlippedHorizontallyFlag);
-    result.setFlippedVertically(gid & FlippedVerticallyFlag);
-    result.setFlippedAntiDiagonally(gid & FlippedAntiDiagonallyFlag);
+    cell.setFlippedHorizontally(gid & FlippedHorizontallyFlag);
+    cell.setFlippedVertically(gid & FlippedVerticallyFlag);
+    cell.setFlippedAntiDiagonally(gid & FlippedAntiDiagonallyFlag);
 
-    result.setRotatedHexagonal120(gid & RotatedHexagonal120Flag);
+    cell.setRotatedHexagonal120(gid & RotatedHexagonal120Flag);
 
     // Clear the flags
     gid &= ~(FlippedHorizontallyFlag |
@@ -86,31 +139,55 @@ Cell GidMapper::gidToCell(unsigned gid, bool &ok) const
              FlippedAntiDiagonallyFlag |
              RotatedHexagonal120Flag);
 
-    if (gid == 0) {
-        ok = true;
-    } else if (isEmpty()) {
-        ok = false;
-    } else {
+    if (gid == 0)
+        return true;
+
+    if (gid < mCachedFirstGid || gid >= mCachedEndGid) {
         // Find the tileset containing this tile
         QMap<unsigned, SharedTileset>::const_iterator i = mFirstGidToTileset.upperBound(gid);
         if (i == mFirstGidToTileset.begin()) {
             // Invalid global tile ID, since it lies before the first tileset
-            ok = false;
-        } else {
-            --i; // Navigate one tileset back since upper bound finds the next
-            int tileId = gid - i.key();
-            const SharedTileset &tileset = i.value();
+            // (or there are no tilesets at all)
+            resetCachedRange();
+            return false;
+        }
+
+        mCachedEndGid = i == mFirstGidToTileset.end() ? std::numeric_limits<unsigned>::max()
+                                                      : i.key();
+
+        --i; // Navigate one tileset back since upper bound finds the next
+        mCachedFirstGid = i.key();
+        mCachedTileset = i.value().data();
+    }
 
-            result.setTile(tileset.data(), tileId);
-            ok = true;
+    const int tileId = gid - mCachedFirstGid;
+    cell.setTile(mCachedTileset, tileId);
 
-            // Adjust the next tile ID, in order to preserve tile references
-            // even to tilesets that failed to load.
-            tileset->setNextTileId(std::max(tileset->nextTileId(), tileId + 1));
+    // Adjust the next tile ID, in order to preserve tile references
+    // even to tilesets that failed to load.
+    if (tileId >= mCachedTileset->nextTileId()) {
+        if (mDeferTilesetUpdates) {
+            int &nextTileId = mDeferredNextTileIds[mCachedTileset];
+            nextTileId = std::max(nextTileId, tileId + 1);
+        } else {
+            mCachedTileset->setNextTileId(tileId + 1);
         }
     }
 
-    return result;
+    return true;
+}
+
+/**
+ * Applies the tileset changes that were deferred while decoding.
+ *
+ * \sa setDeferTilesetUpdates()
+ */
+void GidMapper::applyDeferredTilesetUpdates() const
+{
+    for (auto it = mDeferredNextTileIds.cbegin(); it != mDeferredNextTileIds.cend(); ++it)
+        it.key()->setNextTileId(std::max(it.key()->nextTileId(), it.value()));
+
+    mDeferredNextTileIds.clear();
 }
 
 /**
@@ -122,18 +199,12 @@ unsigned GidMapper::cellToGid(const Cell &cell) const
     if (cell.isEmpty())
         return 0;
 
-    const Tileset *tileset = cell.tileset();
-
     // Find the first GID for the tileset
-    QMap<unsigned, SharedTileset>::const_iterator i = mFirstGidToTileset.begin();
-    QMap<unsigned, SharedTileset>::const_iterator i_end = mFirstGidToTileset.end();
-    while (i != i_end && i.value() != tileset)
-        ++i;
-
-    if (i == i_end) // tileset not found
+    const auto i = mTilesetToFirstGid.constFind(cell.tileset());
+    if (i == mTilesetToFirstGid.constEnd()) // tileset not found
         return 0;
 
-    unsigned gid = i.key() + cell.tileId();
+    unsigned gid = i.value() + cell.tileId();
     if (cell.flippedHorizontally())
         gid |= FlippedHorizontallyFlag;
     if (cell.flippedVertically())
@@ -184,6 +255,290 @@ QByteArray GidMapper::encodeLayerData(const TileLayer &tileLayer,
     return tileData.toBase64();
 }
 
+/**
+ * Encodes the layer data of all tile layers in the given \a map up front,
+ * compressing the layers (or their chunks, for infinite maps) in parallel.
+ *
+ * The returned data can be looked up while writing the layers, so that a
+ * writer can still write them in document order. The output is identical
+ * to encoding them one after another.
+ *
+ * The map must not be changed while the returned data is in use.
+ */
+EncodedLayerData GidMapper::encodeLayerDataInParallel(const Map &map,
+                                                      Map::LayerDataFormat format,
+                                                      QSize chunkSize,
+                                                      int compressionLevel) const
+{
+    EncodedLayerData encoded;
+
+    if (format == Map::XML || format == Map::CSV)
+        return encoded;
+
+    struct EncodeJob {
+        const TileLayer *tileLayer;
+        QRect bounds;
+        QByteArray data;
+    };
+
+    QVector<EncodeJob> jobs;
+
+    for (const Layer *layer : map.tileLayers()) {
+        const TileLayer *tileLayer = static_cast<const TileLayer*>(layer);
+
+        if (map.infinite()) {
+            const auto chunks = tileLayer->sortedChunksToWrite(chunkSize);
+            for (const QRect &rect : chunks)
+                jobs.append(EncodeJob { tileLayer, rect, QByteArray() });
+        } else {
+            jobs.append(EncodeJob { tileLayer,
+                                    QRect(0, 0, tileLayer->width(), tileLayer->height()),
+                                    QByteArray() });
+        }
+    }
+
+    // Not worth the overhead when there is nothing to do in parallel
+    if (jobs.size() < 2)
+        return encoded;
+
+    QtConcurrent::blockingMap(jobs, [&] (EncodeJob &job) {
+        job.data = encodeLayerData(*job.tileLayer, format,
+                                   job.bounds, compressionLevel);
+    });
+
+    encoded.mFormat = format;
+    encoded.mCompressionLevel = compressionLevel;
+    encoded.mEntries.reserve(jobs.size());
+
+    for (EncodeJob &job : jobs) {
+        encoded.mEntries.insert(qMakePair(job.tileLayer, job.bounds.topLeft()),
+                                EncodedLayerData::Entry { job.bounds, std::move(job.data) });
+    }
+
+    return encoded;
+}
+
+/**
+ * Returns the data encoded for the given \a bounds of \a tileLayer, or a
+ * null byte array when that data wasn't encoded with the same format and
+ * compression level.
+ */
+QByteArray EncodedLayerData::find(const TileLayer &tileLayer,
+                                  Map::LayerDataFormat format,
+                                  QRect bounds,
+                                  int compressionLevel) const
+{
+    if (mEntries.isEmpty() || format != mFormat || compressionLevel != mCompressionLevel)
+        return QByteArray();
+
+    if (bounds.isEmpty())
+        bounds = QRect(0, 0, tileLayer.width(), tileLayer.height());
+
+    auto it = mEntries.find(qMakePair(&tileLayer, bounds.topLeft()));
+    if (it != mEntries.end() && it->bounds == bounds)
+        return it->data;
+
+    return QByteArray();
+}
+
+namespace {
+
+/**
+ * Collects decoded layer data into rows of GIDs, and places each complete row
+ * on the tile layer.
+ */
+class LayerDataSink
+{
+public:
+    LayerDataSink(const GidMapper &gidMapper, TileLayer &tileLayer, QRect bounds)
+        : mGidMapper(gidMapper)
+        , mTileLayer(tileLayer)
+        , mBounds(bounds)
+        , mExpectedCount(static_cast<qint64>(std::max(0, bounds.width())) *
+                         std::max(0, bounds.height()))
+        , mRow(std::max(0, bounds.width()))
+        , mY(bounds.y())
+    {}
+
+    bool append(const char *data, int length);
+    GidMapper::DecodeError finish();
+
+    GidMapper::DecodeError error() const { return mError; }
+
+private:
+    bool appendGid(unsigned gid);
+
+    const GidMapper &mGidMapper;
+    TileLayer &mTileLayer;
+    const QRect mBounds;
+    const qint64 mExpectedCount;
+    qint64 mCount = 0;
+    QVector<unsigned> mRow;
+    int mRowSize = 0;
+    int mY;
+    uchar mPartialGid[4];
+    int mPartialGidSize = 0;
+    GidMapper::DecodeError mError = GidMapper::NoError;
+};
+
+bool LayerDataSink::append(const char *data, int length)
+{
+    const uchar *bytes = reinterpret_cast<const uchar*>(data);
+    const uchar *end = bytes + length;
+
+    // Complete a GID that was split over the previous block
+    while (mPartialGidSize > 0 && bytes != end) {
+        mPartialGid[mPartialGidSize++] = *bytes++;
+        if (mPartialGidSize == 4) {
+            mPartialGidSize = 0;
+            if (!appendGid(qFromLittleEndian<quint32>(mPartialGid)))
+                return false;
+        }
+    }
+
+    for (; end - bytes >= 4; bytes += 4)
+        if (!appendGid(qFromLittleEndian<quint32>(bytes)))
+            return false;
+
+    while (bytes != end)
+        mPartialGid[mPartialGidSize++] = *bytes++;
+
+    return true;
+}
+
+bool LayerDataSink::appendGid(unsigned gid)
+{
+    if (mCount == mExpectedCount) {
+        mError = GidMapper::CorruptLayerData;
+        return false;
+    }
+
+    ++mCount;
+    mRow[mRowSize++] = gid;
+
+    if (mRowSize == mRow.size()) {
+        mError = mGidMapper.decodeLayerRow(mTileLayer, mBounds.x(), mY,
+                                           mRow.constData(), mRowSize);
+        mRowSize = 0;
+        ++mY;
+    }
+
+    return mError == GidMapper::NoError;
+}
+
+GidMapper::DecodeError LayerDataSink::finish()
+{
+    if (mError == GidMapper::NoError && (mPartialGidSize > 0 || mCount != mExpectedCount))
+        mError = GidMapper::CorruptLayerData;
+
+    return mError;
+}
+
+inline ushort charCode(char c) { return static_cast<uchar>(c); }
+inline ushort charCode(QChar c) { return c.unicode(); }
+
+inline int base64Value(ushort c)
+{
+    if (c >= 'A' && c <= 'Z')
+        return c - 'A';
+    if (c >= 'a' && c <= 'z')
+        return c - 'a' + 26;
+    if (c >= '0' && c <= '9')
+        return c - '0' + 52;
+    if (c == '+')
+        return 62;
+    if (c == '/')
+        return 63;
+    return -1;
+}
+
+/**
+ * Decodes base64 encoded and optionally compressed layer data, without
+ * holding the decoded or decompressed data in memory as a whole.
+ *
+ * The base64 decoding is done in blocks, each of which is passed on to the
+ * decompressor (if any) which in turn passes its output on in blocks.
+ * Like QByteArray::fromBase64, any characters outside of the base64 alphabet
+ * (like whitespace and padding) are ignored.
+ */
+template <typename Char>
+GidMapper::DecodeError decodeBase64LayerData(const GidMapper &gidMapper,
+                                             TileLayer &tileLayer,
+                                             const Char *text,
+                                             int length,
+                                             Map::LayerDataFormat format,
+                                             QRect bounds)
+{
+    LayerDataSink sink(gidMapper, tileLayer, bounds);
+
+    std::unique_ptr<Decompressor> decompressor;
+    const auto output = [&sink] (const char *data, int size) {
+        return sink.append(data, size);
+    };
+
+    switch (format) {
+    case Map::Base64Gzip:
+        decompressor = std::make_unique<Decompressor>(Gzip, output);
+        break;
+    case Map::Base64Zlib:
+        decompressor = std::make_unique<Decompressor>(Zlib, output);
+        break;
+    case Map::Base64Zstandard:
+        decompressor = std::make_unique<Decompressor>(Zstandard, output);
+        break;
+    default:
+        break;
+    }
+
+    char block[DecodeBlockSize];
+    int blockSize = 0;
+    bool ok = true;
+
+    auto flush = [&] {
+        ok = decompressor ? decompressor->write(block, blockSize)
+                          : sink.append(block, blockSize);
+        blockSize = 0;
+    };
+
+    uint bits = 0;
+    int bitCount = 0;
+
+    for (int i = 0; i < length && ok; ++i) {
+        const int value = base64Value(charCode(text[i]));
+        if (value == -1)
+            continue;
+
+        bits = (bits << 6) | value;
+        bitCount += 6;
+
+        if (bitCount >= 8) {
+            bitCount -= 8;
+            block[blockSize++] = static_cast<char>(bits >> bitCount);
+            bits &= (1 << bitCount) - 1;
+
+            if (blockSize == DecodeBlockSize)
+                flush();
+        }
+    }
+
+    if (ok && blockSize > 0)
+        flush();
+    if (ok && decompressor)
+        ok = decompressor->finish();
+
+    if (!ok)
+        return sink.error() != GidMapper::NoError ? sink.error()
+                                                  : GidMapper::CorruptLayerData;
+
+    return sink.finish();
+}
+
+} // anonymous namespace
+
+/**
+ * Decodes the base64 encoded and optionally compressed \a layerData in the
+ * given \a format, placing the cells within \a bounds on \a tileLayer.
+ */
 GidMapper::DecodeError GidMapper::decodeLayerData(TileLayer &tileLayer,
                                                   const QByteArray &layerData,
                                                   Map::LayerDataFormat format,
@@ -192,43 +547,58 @@ GidMapper::DecodeError GidMapper::decodeLayerData(TileLayer &tileLayer,
     Q_ASSERT(format != Map::XML);
     Q_ASSERT(format != Map::CSV);
 
-    QByteArray decodedData = QByteArray::fromBase64(layerData);
-    const int size = bounds.width() * bounds.height() * 4;
+    return decodeBase64LayerData(*this, tileLayer,
+                                 layerData.constData(), layerData.size(),
+                                 format, bounds);
+}
 
-    if (format == Map::Base64Gzip)
-        decodedData = decompress(decodedData, size, Gzip);
-    else if (format == Map::Base64Zlib)
-        decodedData = decompress(decodedData, size, Zlib);
-    else if (format == Map::Base64Zstandard)
-        decodedData = decompress(decodedData, size, Zstandard);
-
-    if (size != decodedData.length())
-        return CorruptLayerData;
-
-    const unsigned char *data = reinterpret_cast<const unsigned char*>(decodedData.constData());
-    int x = bounds.x();
-    int y = bounds.y();
-    bool ok;
-
-    for (int i = 0; i < size - 3; i += 4) {
-        const unsigned gid = data[i] |
-                             data[i + 1] << 8 |
-                             data[i + 2] << 16 |
-                             data[i + 3] << 24;
-
-        const Cell result = gidToCell(gid, ok);
-        if (!ok) {
-            mInvalidTile = gid;
-            return isEmpty() ? TileButNoTilesets : InvalidTile;
-        }
+/**
+ * Overload that decodes the layer data directly from the given text, which
+ * avoids converting it to a QByteArray first.
+ */
+GidMapper::DecodeError GidMapper::decodeLayerData(TileLayer &tileLayer,
+                                                  const QChar *layerData,
+                                                  int length,
+                                                  Map::LayerDataFormat format,
+                                                  QRect bounds) const
+{
+    Q_ASSERT(format != Map::XML);
+    Q_ASSERT(format != Map::CSV);
 
-        tileLayer.setCell(x, y, result);
+    return decodeBase64LayerData(*this, tileLayer,
+                                 layerData, length,
+                                 format, bounds);
+}
 
-        x++;
-        if (x > bounds.right()) {
-            x = bounds.x();
-            y++;
+/**
+ * Decodes \a count global tile IDs and places the resulting cells on row
+ * \a y of the given \a tileLayer, starting at \a x.
+ *
+ * This is faster than calling gidToCell() and TileLayer::setCell() for each
+ * tile, since the cells are written to the layer one chunk row at a time.
+ */
+GidMapper::DecodeError GidMapper::decodeLayerRow(TileLayer &tileLayer,
+                                                 int x, int y,
+                                                 const unsigned *gids,
+                                                 int count) const
+{
+    Cell cells[CHUNK_SIZE];
+
+    while (count > 0) {
+        const int segment = std::min(count, CHUNK_SIZE - (x & CHUNK_MASK));
+
+        for (int i = 0; i < segment; ++i) {
+            if (!decodeCell(gids[i], cells[i])) {
+                mInvalidTile = gids[i];
+                return isEmpty() ? TileButNoTilesets : InvalidTile;
+            }
         }
+
+        tileLayer.setCellRow(x, y, cells, segment);
+
+        x += segment;
+        gids += segment;
+        count -= segment;
     }
 
     return NoError;
@@ -31,10 +31,43 @@
 #include "map.h"
 #include "tilelayer.h"
 
+#include <QHash>
 #include <QMap>
 
 namespace Tiled {
 
+/**
+ * Tile layer data encoded up front by GidMapper::encodeLayerDataInParallel.
+ *
+ * The data refers to the layers by address, so it is only valid while the
+ * encoded map remains unchanged. It is meant to be kept only while writing
+ * that map.
+ */
+class TILEDSHARED_EXPORT EncodedLayerData
+{
+public:
+    bool isEmpty() const { return mEntries.isEmpty(); }
+    void clear() { mEntries.clear(); }
+
+    QByteArray find(const TileLayer &tileLayer,
+                    Map::LayerDataFormat format,
+                    QRect bounds,
+                    int compressionLevel) const;
+
+private:
+    friend class GidMapper;
+
+    struct Entry {
+        QRect bounds;
+        QByteArray data;
+    };
+
+    // Keyed by the layer and the top-left of the encoded area
+    QHash<QPair<const TileLayer*, QPoint>, Entry> mEntries;
+    Map::LayerDataFormat mFormat = Map::Base64;
+    int mCompressionLevel = -1;
+};
+
 /**
  * A class that maps cells to global IDs (gids) and back.
  */
@@ -56,6 +89,11 @@ public:
                                QRect bounds = QRect(),
                                int compressionLevel = -1) const;
 
+    EncodedLayerData encodeLayerDataInParallel(const Map &map,
+                                               Map::LayerDataFormat format,
+                                               QSize chunkSize,
+                                               int compressionLevel = -1) const;
+
     enum DecodeError {
         NoError = 0,
         CorruptLayerData,
@@ -68,22 +106,40 @@ public:
                                 Map::LayerDataFormat format,
                                 QRect bounds) const;
 
+    DecodeError decodeLayerData(TileLayer &tileLayer,
+                                const QChar *layerData,
+                                int length,
+                                Map::LayerDataFormat format,
+                                QRect bounds) const;
+
+    DecodeError decodeLayerRow(TileLayer &tileLayer,
+                               int x, int y,
+                               const unsigned *gids,
+                               int count) const;
+
     unsigned invalidTile() const;
 
+    void setDeferTilesetUpdates(bool defer);
+    void applyDeferredTilesetUpdates() const;
+
 private:
+    bool decodeCell(unsigned gid, Cell &cell) const;
+    void resetCachedRange() const;
+
     QMap<unsigned, SharedTileset> mFirstGidToTileset;
+    QHash<const Tileset*, unsigned> mTilesetToFirstGid;
+
+    // The GID range of the tileset found by the last call to decodeCell
+    mutable Tileset *mCachedTileset = nullptr;
+    mutable unsigned mCachedFirstGid = 0;
+    mutable unsigned mCachedEndGid = 0;
 
     mutable unsigned mInvalidTile = 0;
-};
 
+    bool mDeferTilesetUpdates = false;
+    mutable QHash<Tileset*, int> mDeferredNextTileIds;
+};
 
-/**
- * Insert the given \a tileset with \a firstGid as its first global ID.
- */
-inline void GidMapper::insert(unsigned firstGid, const SharedTileset &tileset)
-{
-    mFirstGidToTileset.insert(firstGid, tileset);
-}
 
 /**
  * Clears the gid mapper, so that it can be reused.
@@ -91,6 +147,8 @@ inline void GidMapper::insert(unsigned firstGid, const SharedTileset &tileset)
 inline void GidMapper::clear()
 {
     mFirstGidToTileset.clear();
+    mTilesetToFirstGid.clear();
+    resetCachedRange();
 }
 
 /**
@@ -101,6 +159,13 @@ inline bool GidMapper::isEmpty() const
     return mFirstGidToTileset.isEmpty();
 }
 
+inline void GidMapper::resetCachedRange() const
+{
+    mCachedTileset = nullptr;
+    mCachedFirstGid = 0;
+    mCachedEndGid = 0;
+}
+
 /**
  * Returns the GID of the invalid tile in case decodeLayerData() returns
  * the InvalidTile error.
@@ -110,4 +175,15 @@ inline unsigned GidMapper::invalidTile() const
     return mInvalidTile;
 }
 
+/**
+ * When decoding tiles beyond the current next tile ID of a tileset, the next
+ * tile ID of that tileset is adjusted. This function allows to defer these
+ * changes until applyDeferredTilesetUpdates() is called, which is necessary
+ * when using copies of this gid mapper to decode layers in parallel.
+ */
+inline void GidMapper::setDeferTilesetUpdates(bool defer)
+{
+    mDeferTilesetUpdates = defer;
+}
+
 } // namespace Tiled
@@ -28,6 +28,7 @@
 
 #pragma once
 
+#include "pointhash.h"
 #include "tiled_global.h"
 
 #include <QHash>
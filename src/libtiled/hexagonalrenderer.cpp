@@ -295,11 +295,22 @@ QPointF HexagonalRenderer::snapToGrid(const QPointF &pixelCoords, int subdivisio
     return nearest;
 }
 
-void HexagonalRenderer::drawTileLayer(const RenderTileCallback &renderTile,
+void HexagonalRenderer::drawTileSpans(const RenderSpanCallback &renderSpan,
                                       const QRectF &exposed) const
 {
     const RenderParams p(map());
 
+    const int columnStride = p.tileWidth + p.sideLengthX;
+    if (columnStride <= 0)
+        return;
+
+    TileSpan span;
+    span.posStep = QPointF(columnStride, 0);
+
+    auto spanCount = [&] (int startX) {
+        return qMax(0, qCeil((exposed.right() - startX) / columnStride));
+    };
+
     // Determine the tile and pixel coordinates to start at
     QPoint startTile = screenToTileCoords(exposed.topLeft()).toPoint();
     QPoint startPos = tileToScreenCoords(startTile).toPoint();
@@ -323,15 +334,14 @@ void HexagonalRenderer::drawTileLayer(const RenderTileCallback &renderTile,
 
         bool staggeredRow = p.doStaggerX(startTile.x());
 
-        while (startPos.y() - p.tileHeight < exposed.bottom()) {
-            QPoint rowTile = startTile;
-            QPoint rowPos = startPos;
-
-            for (; rowPos.x() < exposed.right(); rowTile.rx() += 2) {
-                renderTile(rowTile, rowPos);
+        // Each row skips the staggered columns, which are on the next row
+        span.tileStep = QPoint(2, 0);
 
-                rowPos.rx() += p.tileWidth + p.sideLengthX;
-            }
+        while (startPos.y() - p.tileHeight < exposed.bottom()) {
+            span.startTile = startTile;
+            span.startPos = startPos;
+            span.count = spanCount(startPos.x());
+            renderSpan(span);
 
             if (staggeredRow) {
                 startTile.rx() -= 1;
@@ -354,18 +364,18 @@ void HexagonalRenderer::drawTileLayer(const RenderTileCallback &renderTile,
         if (p.doStaggerY(startTile.y()))
             startPos.rx() -= p.columnWidth;
 
+        span.tileStep = QPoint(1, 0);
+
         for (; startPos.y() - p.tileHeight < exposed.bottom(); startTile.ry()++) {
-            QPoint rowTile = startTile;
             QPoint rowPos = startPos;
 
             if (p.doStaggerY(startTile.y()))
                 rowPos.rx() += p.columnWidth;
 
-            for (; rowPos.x() < exposed.right(); rowTile.rx()++) {
-                renderTile(rowTile, rowPos);
-
-                rowPos.rx() += p.tileWidth + p.sideLengthX;
-            }
+            span.startTile = startTile;
+            span.startPos = rowPos;
+            span.count = spanCount(rowPos.x());
+            renderSpan(span);
 
             startPos.ry() += p.rowHeight;
         }
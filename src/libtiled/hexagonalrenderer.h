@@ -83,8 +83,7 @@ public:
     QPointF snapToGrid(const QPointF &pixelCoords,
                        int subdivisions) const override;
 
-    using MapRenderer::drawTileLayer;
-    void drawTileLayer(const RenderTileCallback &renderTile,
+    void drawTileSpans(const RenderSpanCallback &renderSpan,
                        const QRectF &exposed) const override;
 
     void drawTileSelection(QPainter *painter,
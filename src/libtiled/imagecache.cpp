@@ -38,6 +38,10 @@
 #include <QBitmap>
 #include <QCoreApplication>
 #include <QFileInfo>
+#include <QMutex>
+#include <QPainter>
+
+#include <limits>
 
 namespace Tiled {
 
@@ -71,6 +75,8 @@ struct CutTiles
     operator const QVector<QPixmap> &() const { return tiles; }
 
     QVector<QPixmap> tiles;
+    QVector<QRect> rects;   // location of each tile on the tilesheet
+    QPixmap tilesheet;      // created on demand by loadTilesheet()
     QDateTime lastModified;
 };
 
@@ -104,6 +110,11 @@ LoadedPixmap::LoadedPixmap(const LoadedImage &cachedImage)
 QHash<QString, LoadedImage> ImageCache::sLoadedImages;
 QHash<QString, LoadedPixmap> ImageCache::sLoadedPixmaps;
 QHash<TilesheetParameters, CutTiles> ImageCache::sCutTiles;
+QCache<QPair<qint64, QRgb>, QPixmap> ImageCache::sTintedPixmaps(64 * 1024);   // in kilobytes
+TintCacheStatistics ImageCache::sTintCacheStatistics;
+
+// Tinted pixmaps may be requested while rendering in multiple threads
+static QMutex tintCacheMutex;
 
 LoadedImage ImageCache::loadImage(const QString &fileName)
 {
@@ -173,17 +184,15 @@ static CutTiles cutTilesImpl(const TilesheetParameters &p)
             }
 
             result.tiles.append(tilePixmap);
+            result.rects.append(QRect(x, y, p.tileWidth, p.tileHeight));
         }
     }
 
     return result;
 }
 
-QVector<QPixmap> ImageCache::cutTiles(const TilesheetParameters &parameters)
+CutTiles &ImageCache::findCutTiles(const TilesheetParameters &parameters)
 {
-    if (parameters.fileName.isEmpty())
-        return {};
-
     auto it = sCutTiles.find(parameters);
 
     bool found = it != sCutTiles.end();
@@ -197,11 +206,135 @@ QVector<QPixmap> ImageCache::cutTiles(const TilesheetParameters &parameters)
     return it.value();
 }
 
+/**
+ * Returns the tiles cut from the tilesheet described by \a parameters. When
+ * given, \a tileRects is set to the location of each tile on the tilesheet.
+ */
+QVector<QPixmap> ImageCache::cutTiles(const TilesheetParameters &parameters,
+                                      QVector<QRect> *tileRects)
+{
+    if (parameters.fileName.isEmpty())
+        return {};
+
+    const CutTiles &cutTiles = findCutTiles(parameters);
+    if (tileRects)
+        *tileRects = cutTiles.rects;
+
+    return cutTiles;
+}
+
+/**
+ * Returns the whole tilesheet described by \a parameters, with the
+ * transparent color masked out, which allows drawing its tiles from a single
+ * pixmap.
+ *
+ * Since this pixmap duplicates the memory used by the tiles, it is only
+ * created when first requested.
+ */
+QPixmap ImageCache::loadTilesheet(const TilesheetParameters &parameters)
+{
+    if (parameters.fileName.isEmpty())
+        return {};
+
+    CutTiles &cutTiles = findCutTiles(parameters);
+
+    if (cutTiles.tilesheet.isNull()) {
+        const QImage image = loadImage(parameters.fileName);
+        cutTiles.tilesheet = QPixmap::fromImage(image);
+
+        if (parameters.transparentColor.isValid()) {
+            const QImage mask = image.createMaskFromColor(parameters.transparentColor.rgb());
+            cutTiles.tilesheet.setMask(QBitmap::fromImage(mask));
+        }
+    }
+
+    return cutTiles.tilesheet;
+}
+
+static QPixmap tintedImpl(const QPixmap &pixmap, const QColor &color)
+{
+    QPixmap resultImage = pixmap;
+    QPainter painter(&resultImage);
+
+    QColor fullOpacity = color;
+    fullOpacity.setAlpha(255);
+    // tint the final color (this will will mess up the alpha which we will fix
+    // in the next lines)
+    painter.setCompositionMode(QPainter::CompositionMode_Multiply);
+    painter.fillRect(resultImage.rect(), fullOpacity);
+
+    // apply the original alpha to the final image
+    painter.setCompositionMode(QPainter::CompositionMode_DestinationIn);
+    painter.drawPixmap(0, 0, pixmap);
+
+    // apply the alpha of the tint color so that we can use it to make the image
+    // transparent instead of just increasing or decreasing the tint effect
+    painter.setCompositionMode(QPainter::CompositionMode_DestinationIn);
+    painter.fillRect(resultImage.rect(), color);
+
+    painter.end();
+
+    return resultImage;
+}
+
+/**
+ * Returns the given \a pixmap tinted with the given \a color. Tinted
+ * pixmaps are cached, so that they don't need to be tinted again for each
+ * repaint. The least recently used ones are dropped when the cache limit
+ * is reached.
+ */
+QPixmap ImageCache::tinted(const QPixmap &pixmap, const QColor &color)
+{
+    if (!color.isValid() || color == QColor(255, 255, 255, 255) || pixmap.isNull())
+        return pixmap;
+
+    const QPair<qint64, QRgb> key(pixmap.cacheKey(), color.rgba());
+
+    {
+        QMutexLocker locker(&tintCacheMutex);
+        if (const QPixmap *cached = sTintedPixmaps.object(key)) {
+            ++sTintCacheStatistics.hits;
+            return *cached;
+        }
+        ++sTintCacheStatistics.misses;
+    }
+
+    const QPixmap result = tintedImpl(pixmap, color);
+
+    // The cost is in kilobytes, computed in 64-bit to avoid overflowing for
+    // large images
+    const qint64 bytes = qint64(result.width()) * result.height() * result.depth() / 8;
+    const int cost = int(qBound<qint64>(1, bytes / 1024, std::numeric_limits<int>::max()));
+
+    QMutexLocker locker(&tintCacheMutex);
+    sTintedPixmaps.insert(key, new QPixmap(result), cost);
+
+    return result;
+}
+
+/**
+ * Returns how often tinted pixmaps were found in the cache, along with the
+ * number of currently cached tinted pixmaps.
+ */
+TintCacheStatistics ImageCache::tintCacheStatistics()
+{
+    QMutexLocker locker(&tintCacheMutex);
+    TintCacheStatistics statistics = sTintCacheStatistics;
+    statistics.count = sTintedPixmaps.count();
+    return statistics;
+}
+
 void ImageCache::remove(const QString &fileName)
 {
     sLoadedImages.remove(fileName);
     sLoadedPixmaps.remove(fileName);
 
+    // The image may have changed, so forget any tinted pixmaps as well
+    {
+        QMutexLocker locker(&tintCacheMutex);
+        sTintedPixmaps.clear();
+    }
+
     // Also remove any previously cut tiles
     QMutableHashIterator<TilesheetParameters, CutTiles> it(sCutTiles);
     while (it.hasNext()) {
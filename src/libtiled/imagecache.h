@@ -30,6 +30,7 @@
 
 #include "tiled_global.h"
 
+#include <QCache>
 #include <QColor>
 #include <QDateTime>
 #include <QHash>
@@ -68,6 +69,22 @@ struct LoadedImage
     QDateTime lastModified;
 };
 
+/**
+ * Counts how often a tinted pixmap was found in the cache.
+ */
+struct TintCacheStatistics
+{
+    quint64 hits = 0;
+    quint64 misses = 0;
+    int count = 0;      // number of cached tinted pixmaps
+
+    qreal hitRate() const
+    {
+        const quint64 total = hits + misses;
+        return total ? qreal(hits) / total : 0.0;
+    }
+};
+
 struct CutTiles;
 struct LoadedPixmap;
 class Map;
@@ -77,16 +94,24 @@ class TILEDSHARED_EXPORT ImageCache
 public:
     static LoadedImage loadImage(const QString &fileName);
     static QPixmap loadPixmap(const QString &fileName);
-    static QVector<QPixmap> cutTiles(const TilesheetParameters &parameters);
+    static QVector<QPixmap> cutTiles(const TilesheetParameters &parameters,
+                                     QVector<QRect> *tileRects = nullptr);
+    static QPixmap loadTilesheet(const TilesheetParameters &parameters);
+
+    static QPixmap tinted(const QPixmap &pixmap, const QColor &color);
+    static TintCacheStatistics tintCacheStatistics();
 
     static void remove(const QString &fileName);
 
 private:
+    static CutTiles &findCutTiles(const TilesheetParameters &parameters);
     static QImage renderMap(const QString &fileName);
 
     static QHash<QString, LoadedImage> sLoadedImages;
     static QHash<QString, LoadedPixmap> sLoadedPixmaps;
     static QHash<TilesheetParameters, CutTiles> sCutTiles;
+    static QCache<QPair<qint64, QRgb>, QPixmap> sTintedPixmaps;
+    static TintCacheStatistics sTintCacheStatistics;
 };
 
 } // namespace Tiled
@@ -266,7 +266,7 @@ void IsometricRenderer::drawGrid(QPainter *painter, const QRectF &rect,
     }
 }
 
-void IsometricRenderer::drawTileLayer(const RenderTileCallback &renderTile,
+void IsometricRenderer::drawTileSpans(const RenderSpanCallback &renderSpan,
                                       const QRectF &exposed) const
 {
     const int tileWidth = map()->tileWidth();
@@ -305,18 +305,20 @@ void IsometricRenderer::drawTileLayer(const RenderTileCallback &renderTile,
     // Determine whether the current row is shifted half a tile to the right
     bool shifted = inUpperHalf ^ inLeftHalf;
 
+    // Each row advances one column at a time
+    TileSpan span;
+    span.tileStep = QPoint(1, -1);
+    span.posStep = QPointF(tileWidth, 0);
+
     for (int y = startPos.y() * 2; y - tileHeight * 2 < exposed.bottom() * 2;
          y += tileHeight)
     {
-        QPoint columnItr = rowItr;
-
-        for (int x = startPos.x(); x < exposed.right(); x += tileWidth) {
-            renderTile(columnItr, QPointF(x, (qreal)y / 2));
+        const int startX = startPos.x();
 
-            // Advance to the next column
-            ++columnItr.rx();
-            --columnItr.ry();
-        }
+        span.startTile = rowItr;
+        span.startPos = QPointF(startX, (qreal)y / 2);
+        span.count = qMax(0, qCeil((exposed.right() - startX) / tileWidth));
+        renderSpan(span);
 
         // Advance to the next row
         if (!shifted) {
@@ -55,8 +55,7 @@ public:
     void drawGrid(QPainter *painter, const QRectF &rect,
                   QColor grid, QSize gridMajor) const override;
 
-    using MapRenderer::drawTileLayer;
-    void drawTileLayer(const RenderTileCallback &renderTile,
+    void drawTileSpans(const RenderSpanCallback &renderSpan,
                        const QRectF &exposed) const override;
 
     void drawTileSelection(QPainter *painter,
@@ -3,6 +3,7 @@ INCLUDEPATH += $$PWD
 SOURCES += $$PWD/compression.cpp \
     $$PWD/filesystemwatcher.cpp \
     $$PWD/fileformat.cpp \
+    $$PWD/floodfill.cpp \
     $$PWD/gidmapper.cpp \
     $$PWD/grouplayer.cpp \
     $$PWD/hex.cpp \
@@ -38,6 +39,7 @@ SOURCES += $$PWD/compression.cpp \
     $$PWD/tileanimationdriver.cpp \
     $$PWD/tiled.cpp \
     $$PWD/tilelayer.cpp \
+    $$PWD/tileregion.cpp \
     $$PWD/tileset.cpp \
     $$PWD/tilesetformat.cpp \
     $$PWD/tilesetmanager.cpp \
@@ -46,8 +48,10 @@ SOURCES += $$PWD/compression.cpp \
     $$PWD/worldmanager.cpp
 HEADERS += $$PWD/compression.h \
     $$PWD/containerhelpers.h \
+    $$PWD/csvparser.h \
     $$PWD/filesystemwatcher.h \
     $$PWD/fileformat.h \
+    $$PWD/floodfill.h \
     $$PWD/gidmapper.h \
     $$PWD/grid.h \
     $$PWD/grouplayer.h \
@@ -75,6 +79,7 @@ HEADERS += $$PWD/compression.h \
     $$PWD/orthogonalrenderer.h \
     $$PWD/plugin.h \
     $$PWD/pluginmanager.h \
+    $$PWD/pointhash.h \
     $$PWD/properties.h \
     $$PWD/propertytype.h \
     $$PWD/savefile.h \
@@ -85,6 +90,7 @@ HEADERS += $$PWD/compression.h \
     $$PWD/tiled.h \
     $$PWD/tiled_global.h \
     $$PWD/tilelayer.h \
+    $$PWD/tileregion.h \
     $$PWD/tileset.h \
     $$PWD/tilesetformat.h \
     $$PWD/tilesetmanager.h \
@@ -1,5 +1,7 @@
 include(./libtiled-src.pri)
 
+QT += concurrent
+
 !win32 {
     # On other platforms it is necessary to link to zlib explicitly
     LIBS += -lz
@@ -2,6 +2,7 @@ include(../../tiled.pri)
 
 TEMPLATE = lib
 TARGET = tiled
+QT += concurrent
 target.path = $${LIBDIR}
 INSTALLS += target
 macx {
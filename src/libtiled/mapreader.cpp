@@ -31,6 +31,7 @@
 #include "mapreader.h"
 
 #include "compression.h"
+#include "csvparser.h"
 #include "gidmapper.h"
 #include "grouplayer.h"
 #include "imagelayer.h"
@@ -50,7 +51,9 @@
 #include <QFileInfo>
 #include <QVector>
 #include <QXmlStreamReader>
+#include <QtConcurrent/QtConcurrentMap>
 
+#include <algorithm>
 #include <memory>
 
 #include "qtcompat_p.h"
@@ -107,13 +110,13 @@ private:
                            Map::LayerDataFormat layerDataFormat,
                            QStringRef encoding,
                            QRect bounds);
-    void decodeBinaryLayerData(TileLayer &tileLayer,
-                               const QByteArray &data,
-                               Map::LayerDataFormat format,
-                               QRect bounds);
-    void decodeCSVLayerData(TileLayer &tileLayer,
-                            QStringRef text,
-                            QRect bounds);
+    static QString decodeLayerData(const GidMapper &gidMapper,
+                                   TileLayer &tileLayer,
+                                   const QChar *text,
+                                   int length,
+                                   Map::LayerDataFormat format,
+                                   QRect bounds);
+    void decodePendingLayerData();
 
     /**
      * Returns the cell for the given global tile ID. Errors are raised with
@@ -147,6 +150,23 @@ private:
     std::unique_ptr<Map> mMap;
     GidMapper mGidMapper;
     bool mReadingExternalTileset;
+    bool mDecodeInParallel = true;
+
+    // Encoded tile layer data, captured for decoding after the XML is read
+    struct PendingLayerData
+    {
+        TileLayer *tileLayer;
+        QString text;
+        Map::LayerDataFormat format;
+        QRect bounds;
+        qint64 lineNumber;
+        qint64 columnNumber;
+    };
+    QVector<PendingLayerData> mPendingLayerData;
+    qint64 mPendingLayerDataSize = 0;     // in characters
+
+    // Limits the memory used for keeping encoded layer data around
+    static constexpr qint64 MaxPendingLayerDataSize = 16 * 1024 * 1024;
 
     QXmlStreamReader xml;
 };
@@ -310,8 +330,13 @@ std::unique_ptr<Map> MapReaderPrivate::readMap()
             readUnknownElement();
     }
 
+    if (!xml.hasError())
+        decodePendingLayerData();
+    mPendingLayerData.clear();
+    mPendingLayerDataSize = 0;
+
     // Clean up in case of error
-    if (xml.hasError()) {
+    if (xml.hasError() || !mError.isEmpty()) {
         mMap.reset();
     } else {
         // Try to load the tileset images for embedded tilesets
@@ -956,6 +981,11 @@ void MapReaderPrivate::readTileLayerData(TileLayer &tileLayer)
                       layerDataFormat,
                       encoding,
                       QRect(0, 0, tileLayer.width(), tileLayer.height()));
+
+    // Loaded layers are stored compactly until they get edited. Layers with
+    // pending data are compacted once it has been decoded.
+    if (mPendingLayerData.isEmpty() || mPendingLayerData.last().tileLayer != &tileLayer)
+        tileLayer.compact();
 }
 
 void MapReaderPrivate::readTileLayerRect(TileLayer &tileLayer,
@@ -1004,86 +1034,174 @@ void MapReaderPrivate::readTileLayerRect(TileLayer &tileLayer,
                 readUnknownElement();
             }
         } else if (xml.isCharacters() && !xml.isWhitespace()) {
-            if (encoding == QLatin1String("base64")) {
-                decodeBinaryLayerData(tileLayer,
-                                      xml.text().toLatin1(),
-                                      layerDataFormat,
-                                      bounds);
-            } else if (encoding == QLatin1String("csv")) {
-                decodeCSVLayerData(tileLayer, xml.text(), bounds);
+            if (encoding != QLatin1String("base64") && encoding != QLatin1String("csv"))
+                continue;
+
+            const int length = xml.text().size();
+
+            // Decode the pending data when keeping this data too would use
+            // too much memory
+            if (mDecodeInParallel && mPendingLayerDataSize + length > MaxPendingLayerDataSize)
+                decodePendingLayerData();
+
+            if (mDecodeInParallel && length <= MaxPendingLayerDataSize) {
+                mPendingLayerDataSize += length;
+                mPendingLayerData.append(PendingLayerData {
+                                             &tileLayer,
+                                             xml.text().toString(),
+                                             layerDataFormat,
+                                             bounds,
+                                             xml.lineNumber(),
+                                             xml.columnNumber()
+                                         });
+            } else {
+                // Decoding directly from the text avoids copying the layer data
+                const auto text = xml.text();
+                const QString error = decodeLayerData(mGidMapper, tileLayer,
+                                                      text.data(), text.size(),
+                                                      layerDataFormat, bounds);
+                if (!error.isEmpty())
+                    xml.raiseError(error);
             }
         }
     }
 }
 
-void MapReaderPrivate::decodeBinaryLayerData(TileLayer &tileLayer,
-                                             const QByteArray &data,
-                                             Map::LayerDataFormat format,
-                                             QRect bounds)
+/**
+ * Decodes the given base64 or CSV encoded layer data, placing the cells
+ * within \a bounds on \a tileLayer.
+ *
+ * This function is called from multiple threads when decoding in parallel,
+ * so it should not touch any state apart from the given tile layer.
+ *
+ * Returns an error message, or an empty string when decoding succeeded.
+ */
+QString MapReaderPrivate::decodeLayerData(const GidMapper &gidMapper,
+                                          TileLayer &tileLayer,
+                                          const QChar *text,
+                                          int length,
+                                          Map::LayerDataFormat format,
+                                          QRect bounds)
 {
-    GidMapper::DecodeError error;
+    GidMapper::DecodeError error = GidMapper::NoError;
+
+    if (format == Map::CSV) {
+        CsvParser<QChar> parser(text, text + length);
+
+        const int width = std::max(0, bounds.width());
+        QVector<unsigned> gids(width);
+
+        for (int y = bounds.top(); y <= bounds.bottom() && error == GidMapper::NoError; y++) {
+            const int count = parser.read(gids.data(), width);
+
+            switch (parser.error()) {
+            case CsvParser<QChar>::UnexpectedEnd:
+                // The stream ended early.
+                return tr("Corrupt layer data for layer '%1'").arg(tileLayer.name());
+            case CsvParser<QChar>::UnexpectedCharacter:
+                return tr("Unable to parse tile at (%1,%2) on layer '%3': \"%4\"")
+                        .arg(bounds.left() + count + 1).arg(y + 1).arg(tileLayer.name())
+                        .arg(parser.errorCharacter());
+            case CsvParser<QChar>::NoError:
+                break;
+            }
 
-    error = mGidMapper.decodeLayerData(tileLayer, data, format, bounds);
+            error = gidMapper.decodeLayerRow(tileLayer, bounds.left(), y,
+                                             gids.constData(), count);
+        }
+
+        // Check whether we consumed all the data
+        if (error == GidMapper::NoError && !parser.atEnd())
+            error = GidMapper::CorruptLayerData;
+    } else {
+        error = gidMapper.decodeLayerData(tileLayer, text, length, format, bounds);
+    }
 
     switch (error) {
     case GidMapper::CorruptLayerData:
-        xml.raiseError(tr("Corrupt layer data for layer '%1'").arg(tileLayer.name()));
-        return;
+        return tr("Corrupt layer data for layer '%1'").arg(tileLayer.name());
     case GidMapper::TileButNoTilesets:
-        xml.raiseError(tr("Tile used but no tilesets specified"));
-        return;
+        return tr("Tile used but no tilesets specified");
     case GidMapper::InvalidTile:
-        xml.raiseError(tr("Invalid tile: %1").arg(mGidMapper.invalidTile()));
-        return;
+        return tr("Invalid tile: %1").arg(gidMapper.invalidTile());
     case GidMapper::NoError:
         break;
     }
+
+    return QString();
 }
 
-void MapReaderPrivate::decodeCSVLayerData(TileLayer &tileLayer,
-                                          QStringRef text,
-                                          QRect bounds)
+/**
+ * Decodes the layer data captured while reading the map. The data of
+ * different tile layers is decoded in parallel, each using its own copy of
+ * the gid mapper.
+ *
+ * This happens when the map has been read, or earlier when the captured
+ * data reaches MaxPendingLayerDataSize.
+ */
+void MapReaderPrivate::decodePendingLayerData()
 {
-    int currentIndex = 0;
-
-    for (int y = bounds.top(); y <= bounds.bottom(); y++) {
-        for (int x = bounds.left(); x <= bounds.right(); x++) {
-            // Check if the stream ended early.
-            if (currentIndex >= text.length()) {
-                xml.raiseError(tr("Corrupt layer data for layer '%1'")
-                               .arg(tileLayer.name()));
-                return;
-            }
+    struct LayerDecodeJob
+    {
+        TileLayer *tileLayer;
+        int first;  // index of the first pending data for this layer
+        int count;
+        GidMapper gidMapper;
+        QString error;
+        int errorIndex;
+    };
 
-            // Get the next entry.
-            unsigned int gid = 0;
-            while (currentIndex < text.length()) {
-                auto currentChar = text.at(currentIndex);
-                currentIndex++;
-                if (currentChar == QLatin1Char(','))
-                    break;
-                if (currentChar.isSpace())
-                    continue;
-                int value = currentChar.digitValue();
-                if (value != -1)
-                    gid = gid * 10 + value;
-                else {
-                    xml.raiseError(
-                            tr("Unable to parse tile at (%1,%2) on layer '%3': \"%4\"")
-                                   .arg(x + 1).arg(y + 1).arg(tileLayer.name()).arg(currentChar));
-                    return;
-                }
+    QVector<LayerDecodeJob> jobs;
+
+    // The data for each layer (a single <data> or multiple chunks) is
+    // captured consecutively, and only one thread may write to each layer
+    for (int i = 0; i < mPendingLayerData.size(); ++i) {
+        TileLayer *tileLayer = mPendingLayerData.at(i).tileLayer;
+        if (!jobs.isEmpty() && jobs.last().tileLayer == tileLayer)
+            ++jobs.last().count;
+        else
+            jobs.append(LayerDecodeJob { tileLayer, i, 1, mGidMapper, QString(), -1 });
+    }
+
+    const auto &pendingLayerData = mPendingLayerData;
+    auto decodeLayer = [&pendingLayerData] (LayerDecodeJob &job) {
+        job.gidMapper.setDeferTilesetUpdates(true);
+
+        for (int i = job.first; i < job.first + job.count; ++i) {
+            const PendingLayerData &data = pendingLayerData.at(i);
+            job.error = decodeLayerData(job.gidMapper, *job.tileLayer,
+                                        data.text.constData(), data.text.size(),
+                                        data.format, data.bounds);
+            if (!job.error.isEmpty()) {
+                job.errorIndex = i;
+                return;
             }
+        }
 
-            tileLayer.setCell(x, y, cellForGid(gid));
+        // Loaded layers are stored compactly until they get edited
+        job.tileLayer->compact();
+    };
+
+    if (jobs.size() > 1)
+        QtConcurrent::blockingMap(jobs, decodeLayer);
+    else if (jobs.size() == 1)
+        decodeLayer(jobs.first());
+
+    for (const LayerDecodeJob &job : qAsConst(jobs)) {
+        job.gidMapper.applyDeferredTilesetUpdates();
+
+        // Report the first error in document order
+        if (!job.error.isEmpty() && mError.isEmpty()) {
+            const PendingLayerData &data = mPendingLayerData.at(job.errorIndex);
+            mError = tr("%3\n\nLine %1, column %2")
+                    .arg(data.lineNumber)
+                    .arg(data.columnNumber)
+                    .arg(job.error);
         }
     }
-    if (currentIndex < text.length()) {
-        // We didn't consume all the data.
-        xml.raiseError(tr("Corrupt layer data for layer '%1'")
-                       .arg(tileLayer.name()));
-        return;
-    }
+
+    mPendingLayerData.clear();
+    mPendingLayerDataSize = 0;
 }
 
 Cell MapReaderPrivate::cellForGid(unsigned gid)
@@ -1534,6 +1652,11 @@ QString MapReader::errorString() const
     return d->errorString();
 }
 
+void MapReader::setDecodeLayerDataInParallel(bool enabled)
+{
+    d->mDecodeInParallel = enabled;
+}
+
 QString MapReader::resolveReference(const QString &reference,
                                     const QDir &mapDir)
 {
@@ -95,6 +95,17 @@ public:
      */
     QString errorString() const;
 
+    /**
+     * Sets whether tile layer data is decoded in parallel once the whole map
+     * has been read, rather than while reading it. This is enabled by default.
+     *
+     * Decoding in parallel requires the encoded layer data to be kept in
+     * memory. To bound the memory used, the data kept so far is decoded
+     * once it reaches 16M characters, and larger layer data is decoded
+     * right away.
+     */
+    void setDecodeLayerDataInParallel(bool enabled);
+
     std::unique_ptr<ObjectTemplate> readObjectTemplate(QIODevice *device, const QString &path = QString());
     std::unique_ptr<ObjectTemplate> readObjectTemplate(const QString &fileName);
 
@@ -28,6 +28,7 @@
 
 #include "maprenderer.h"
 
+#include "imagecache.h"
 #include "imagelayer.h"
 #include "isometricrenderer.h"
 #include "map.h"
@@ -48,35 +49,6 @@
 
 using namespace Tiled;
 
-static QPixmap tinted(const QPixmap &pixmap, const QColor &color)
-{
-    if (!color.isValid() || color == QColor(255, 255, 255, 255))
-        return pixmap;
-
-    QPixmap resultImage = pixmap;
-    QPainter painter(&resultImage);
-
-    QColor fullOpacity = color;
-    fullOpacity.setAlpha(255);
-    // tint the final color (this will will mess up the alpha which we will fix
-    // in the next lines)
-    painter.setCompositionMode(QPainter::CompositionMode_Multiply);
-    painter.fillRect(resultImage.rect(), fullOpacity);
-
-    // apply the original alpha to the final image
-    painter.setCompositionMode(QPainter::CompositionMode_DestinationIn);
-    painter.drawPixmap(0, 0, pixmap);
-
-    // apply the alpha of the tint color so that we can use it to make the image
-    // transparent instead of just increasing or decreasing the tint effect
-    painter.setCompositionMode(QPainter::CompositionMode_DestinationIn);
-    painter.fillRect(resultImage.rect(), color);
-
-    painter.end();
-
-    return resultImage;
-}
-
 MapRenderer::~MapRenderer()
 {}
 
@@ -125,7 +97,7 @@ void MapRenderer::drawImageLayer(QPainter *painter,
                                  const QRectF &exposed) const
 {
     painter->save();
-    painter->setBrush(tinted(imageLayer->image(), imageLayer->effectiveTintColor()));
+    painter->setBrush(ImageCache::tinted(imageLayer->image(), imageLayer->effectiveTintColor()));
     painter->setPen(Qt::NoPen);
     if (exposed.isNull())
         painter->drawRect(boundingRect(imageLayer));
@@ -225,16 +197,26 @@ void MapRenderer::drawTileLayer(QPainter *painter, const TileLayer *layer, const
 
     CellRenderer renderer(painter, this, layer->effectiveTintColor());
 
-    auto tileRenderFunction = [layer, &renderer, tileSize](QPoint tilePos, const QPointF &screenPos) {
-        const Cell &cell = layer->cellAt(tilePos - layer->position());
-        if (!cell.isEmpty()) {
+    auto renderSpan = [layer, &renderer, tileSize](const TileSpan &span) {
+        const QPoint start = span.startTile - layer->position();
+
+        layer->forEachCell(start, span.tileStep, span.count, [&] (int index, const Cell &cell) {
             const Tile *tile = cell.tile();
             const QSize size = (tile && !tile->image().isNull()) ? tile->size() : tileSize;
-            renderer.render(cell, screenPos, size, CellRenderer::BottomLeft);
-        }
+            renderer.render(cell, span.screenPos(index), size, CellRenderer::BottomLeft);
+        });
     };
 
-    drawTileLayer(tileRenderFunction, rect);
+    drawTileSpans(renderSpan, rect);
+}
+
+void MapRenderer::drawTileLayer(const RenderTileCallback &renderTile,
+                                const QRectF &exposed) const
+{
+    drawTileSpans([&] (const TileSpan &span) {
+        for (int i = 0; i < span.count; ++i)
+            renderTile(span.tilePos(i), span.screenPos(i));
+    }, exposed);
 }
 
 void MapRenderer::setFlag(RenderFlag flag, bool enabled)
@@ -346,18 +328,55 @@ CellRenderer::CellRenderer(QPainter *painter, const MapRenderer *renderer, const
     , mRenderer(renderer)
     , mTile(nullptr)
     , mIsOpenGL(hasOpenGLEngine(painter))
+    , mUseAtlas(renderer->testFlag(UseTilesetAtlas)
+                && !renderer->testFlag(ShowTileCollisionShapes)
+                && mIsOpenGL)
+    , mSmoothTransform(painter->testRenderHint(QPainter::SmoothPixmapTransform))
     , mTintColor(tintColor)
 {
+    // With smooth scaling at non-integer scales, pixels next to the source
+    // rect would bleed into the tile.
+    if (mUseAtlas && mSmoothTransform) {
+        const QTransform transform = painter->combinedTransform();
+        if (transform.type() > QTransform::TxScale ||
+                transform.m11() != std::round(transform.m11()) ||
+                transform.m22() != std::round(transform.m22())) {
+            mUseAtlas = false;
+        }
+    }
+}
+
+/**
+ * Returns the tileset image of the given \a tile when it should be used to
+ * draw the tile, or a null pixmap otherwise.
+ */
+QPixmap CellRenderer::atlasImage(const Tile *tile, const QSizeF &size)
+{
+    if (!mUseAtlas || tile->imageRect().isNull())
+        return QPixmap();
+
+    // Scaling the tile itself would also cause bleeding
+    if (mSmoothTransform && QSizeF(tile->imageRect().size()) != size)
+        return QPixmap();
+
+    const Tileset *tileset = tile->tileset();
+    auto it = mAtlasImages.find(tileset);
+    if (it == mAtlasImages.end())
+        it = mAtlasImages.insert(tileset, tileset->image());
+
+    return it.value();
 }
 
 /**
  * Renders a \a cell with the given \a origin at \a pos, taking into account
  * the flipping and tile offset.
  *
- * For performance reasons, the actual drawing is delayed until a different
- * kind of tile has to be drawn. For this reason it is necessary to call
- * flush when finished doing drawCell calls. This function is also called by
- * the destructor so usually an explicit call is not needed.
+ * For performance reasons, the actual drawing is delayed until a tile from a
+ * different image has to be drawn. When the UseTilesetAtlas flag is set and
+ * painting with OpenGL, tiles from a tileset image are drawn straight from
+ * that image, so that they can all be drawn in one go. It is necessary to call flush when
+ * finished doing drawCell calls. This function is also called by the
+ * destructor so usually an explicit call is not needed.
  *
  * This call expects `painter.translate(pos)` to correspond to the Origin point.
  */
@@ -378,13 +397,19 @@ void CellRenderer::render(const Cell &cell, const QPointF &screenPos, const QSiz
         return;
     }
 
+    const QPixmap atlasImage = this->atlasImage(tile, size);
+    const bool useAtlas = !atlasImage.isNull();
+    const QPixmap &image = useAtlas ? atlasImage : tile->image();
+    const QRect sourceRect = useAtlas ? tile->imageRect() : image.rect();
+
     // The USHRT_MAX limit is rather arbitrary but avoids a crash in
     // drawPixmapFragments for a large number of fragments.
-    if (mTile != tile || mFragments.size() == USHRT_MAX)
+    if ((!useAtlas && mTile != tile) ||
+            mImage.cacheKey() != image.cacheKey() ||
+            mFragments.size() == USHRT_MAX)
         flush();
 
-    const QPixmap &image = tile->image();
-    const QSizeF imageSize = image.size();
+    const QSizeF imageSize = sourceRect.size();
     if (imageSize.isEmpty())
         return;
 
@@ -399,8 +424,8 @@ void CellRenderer::render(const Cell &cell, const QPointF &screenPos, const QSiz
     // Calculate the position as if the origin is TopLeft, and correct it later.
     fragment.x = screenPos.x() + (offset.x() * scale.width()) + sizeHalf.x();
     fragment.y = screenPos.y() + (offset.y() * scale.height()) + sizeHalf.y();
-    fragment.sourceLeft = 0;
-    fragment.sourceTop = 0;
+    fragment.sourceLeft = sourceRect.x();
+    fragment.sourceTop = sourceRect.y();
     fragment.width = imageSize.width();
     fragment.height = imageSize.height();
     fragment.scaleX = flippedHorizontally ? -1 : 1;
@@ -437,6 +462,7 @@ void CellRenderer::render(const Cell &cell, const QPointF &screenPos, const QSiz
 
     if (mIsOpenGL || (fragment.scaleX > 0 && fragment.scaleY > 0)) {
         mTile = tile;
+        mImage = image;
         mFragments.append(fragment);
         return;
     }
@@ -454,10 +480,11 @@ void CellRenderer::render(const Cell &cell, const QPointF &screenPos, const QSiz
 
     const QRectF target(fragment.width * -0.5, fragment.height * -0.5,
                         fragment.width, fragment.height);
-    const QRectF source(0, 0, fragment.width, fragment.height);
+    const QRectF source(fragment.sourceLeft, fragment.sourceTop,
+                        fragment.width, fragment.height);
 
     mPainter->setTransform(transform);
-    mPainter->drawPixmap(target, tinted(image, mTintColor), source);
+    mPainter->drawPixmap(target, ImageCache::tinted(image, mTintColor), source);
     mPainter->setTransform(oldTransform);
 
     // A bit of a hack to still draw tile collision shapes when requested
@@ -482,7 +509,7 @@ void CellRenderer::flush()
 
     mPainter->drawPixmapFragments(mFragments.constData(),
                                   mFragments.size(),
-                                  tinted(mTile->image(), mTintColor));
+                                  ImageCache::tinted(mImage, mTintColor));
 
     if (mRenderer->flags().testFlag(ShowTileCollisionShapes)
             && mTile->objectGroup()
@@ -491,6 +518,7 @@ void CellRenderer::flush()
     }
 
     mTile = nullptr;
+    mImage = QPixmap();
     mFragments.resize(0);
 }
 
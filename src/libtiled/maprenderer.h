@@ -33,6 +33,7 @@
 #include <functional>
 #include <memory>
 
+#include <QHash>
 #include <QPainter>
 #include <QPainterPath>
 
@@ -44,12 +45,14 @@ class Map;
 class MapObject;
 class Tile;
 class TileLayer;
+class Tileset;
 class ImageLayer;
 
 enum RenderFlag {
     ShowTileObjectOutlines = 0x1,
     ShowTileCollisionShapes = 0x2,
     ShowTileAnimations = 0x4,
+    UseTilesetAtlas = 0x8,      // only used when painting with OpenGL
 };
 
 Q_DECLARE_FLAGS(RenderFlags, RenderFlag)
@@ -142,6 +145,24 @@ public:
 
     using RenderTileCallback = std::function<void (QPoint, const QPointF &)>;
 
+    /**
+     * A row of tiles to render, starting at \a startTile and \a startPos and
+     * advancing by \a tileStep and \a posStep for each of its \a count tiles.
+     */
+    struct TileSpan
+    {
+        QPoint startTile;
+        QPoint tileStep;
+        QPointF startPos;
+        QPointF posStep;
+        int count = 0;
+
+        QPoint tilePos(int index) const { return startTile + tileStep * index; }
+        QPointF screenPos(int index) const { return startPos + posStep * index; }
+    };
+
+    using RenderSpanCallback = std::function<void (const TileSpan &)>;
+
     /**
      * Draws the given \a layer using the given \a painter.
      *
@@ -161,8 +182,20 @@ public:
      * \li \c tilePos - The tile position of the cell being rendered.
      * \li \c screenPos - The screen position of the cell being rendered.
      * \endlist
+     *
+     * \sa drawTileSpans
+     */
+    void drawTileLayer(const RenderTileCallback &renderTile,
+                       const QRectF &exposed) const;
+
+    /**
+     * Calls the given \a renderSpan callback for each row of tiles in the
+     * given \a exposed rectangle, in the order in which the tiles should be
+     * rendered. This avoids a call for each tile.
+     *
+     * \sa TileLayer::forEachCell
      */
-    virtual void drawTileLayer(const RenderTileCallback &renderTile,
+    virtual void drawTileSpans(const RenderSpanCallback &renderSpan,
                                const QRectF &exposed) const = 0;
 
     /**
@@ -339,13 +372,18 @@ public:
     void flush();
 
 private:
+    QPixmap atlasImage(const Tile *tile, const QSizeF &size);
     void paintTileCollisionShapes();
 
     QPainter * const mPainter;
     const MapRenderer * const mRenderer;
     const Tile *mTile;
+    QPixmap mImage;
     QVector<QPainter::PixmapFragment> mFragments;
     const bool mIsOpenGL;
+    bool mUseAtlas;
+    const bool mSmoothTransform;
+    QHash<const Tileset*, QPixmap> mAtlasImages;
     const QColor mTintColor;
 };
 
@@ -113,11 +113,18 @@ QVariant MapToVariantConverter::toVariant(const Map &map, const QDir &mapDir)
     }
     mapVariant[QStringLiteral("tilesets")] = tilesetVariants;
 
+    mEncodedLayerData = mGidMapper.encodeLayerDataInParallel(map,
+                                                             map.layerDataFormat(),
+                                                             map.chunkSize(),
+                                                             map.compressionLevel());
+
     mapVariant[QStringLiteral("layers")] = toVariant(map.layers(),
                                                     map.layerDataFormat(),
                                                     map.compressionLevel(),
                                                     map.chunkSize());
 
+    mEncodedLayerData.clear();
+
     return mapVariant;
 }
 
@@ -718,7 +725,9 @@ void MapToVariantConverter::addTileLayerData(QVariantMap &variant,
     case Map::Base64Zlib:
     case Map::Base64Gzip:
     case Map::Base64Zstandard:{
-        QByteArray layerData = mGidMapper.encodeLayerData(tileLayer, format, bounds, compressionLevel);
+        QByteArray layerData = mEncodedLayerData.find(tileLayer, format, bounds, compressionLevel);
+        if (layerData.isNull())
+            layerData = mGidMapper.encodeLayerData(tileLayer, format, bounds, compressionLevel);
         variant[QStringLiteral("data")] = layerData;
         break;
     }
@@ -90,6 +90,7 @@ private:
     int mVersion;
     QDir mDir;
     GidMapper mGidMapper;
+    EncodedLayerData mEncodedLayerData;     // only valid while converting a map
 };
 
 } // namespace Tiled
@@ -97,6 +97,7 @@ private:
 
     QDir mDir;      // The directory in which the file is being saved
     GidMapper mGidMapper;
+    EncodedLayerData mEncodedLayerData;     // only valid during writeMap
     bool mUseAbsolutePaths { false };
 };
 
@@ -268,8 +269,13 @@ void MapWriterPrivate::writeMap(QXmlStreamWriter &w, const Map &map)
         firstGid += tileset->nextTileId();
     }
 
+    mEncodedLayerData = mGidMapper.encodeLayerDataInParallel(map, mLayerDataFormat,
+                                                             mChunkSize, mCompressionlevel);
+
     writeLayers(w, map.layers());
 
+    mEncodedLayerData.clear();
+
     w.writeEndElement();
 }
 
@@ -620,10 +626,16 @@ void MapWriterPrivate::writeTileLayerData(QXmlStreamWriter &w,
 
         w.writeCharacters(chunkData);
     } else {
-        QByteArray chunkData = mGidMapper.encodeLayerData(tileLayer,
-                                                          mLayerDataFormat,
-                                                          bounds,
-                                                          mCompressionlevel);
+        QByteArray chunkData = mEncodedLayerData.find(tileLayer,
+                                                      mLayerDataFormat,
+                                                      bounds,
+                                                      mCompressionlevel);
+        if (chunkData.isNull()) {
+            chunkData = mGidMapper.encodeLayerData(tileLayer,
+                                                   mLayerDataFormat,
+                                                   bounds,
+                                                   mCompressionlevel);
+        }
 
         if (!mMinimize)
             w.writeCharacters(QLatin1String("\n   "));
@@ -106,19 +106,40 @@ static void extendMapRect(QRect &mapBoundingRect, const MapRenderer &renderer)
     // Start with the basic map size
     QRectF rect(mapBoundingRect);
 
-    // Take into account large tiles extending beyond their cell
+    // Take into account large tiles extending beyond their cell. The cells
+    // are only checked for chunks that may extend beyond the current bounds.
     for (const Layer *layer : renderer.map()->tileLayers()) {
         const TileLayer *tileLayer = static_cast<const TileLayer*>(layer);
         const QPointF offset = tileLayer->totalOffset();
+        const auto &chunks = tileLayer->chunks();
 
-        for (int y = 0; y < tileLayer->height(); ++y) {
-            for (int x = 0; x < tileLayer->width(); ++x) {
-                const Cell &cell = tileLayer->cellAt(x, y);
+        for (auto it = chunks.begin(), it_end = chunks.end(); it != it_end; ++it) {
+            const Chunk &chunk = it.value();
+            const QMargins margins = chunk.drawMargins();
+            if (margins.isNull())
+                continue;   // no tiles
 
-                if (!cell.isEmpty()) {
-                    QRectF r = cellRect(renderer, cell, QPointF(x, y));
-                    r.translate(offset);
-                    rect |= r;
+            const QPoint chunkStart = tileLayer->position() + it.key() * CHUNK_SIZE;
+
+            QRectF chunkBounds = renderer.boundingRect(QRect(chunkStart, QSize(CHUNK_SIZE, CHUNK_SIZE)));
+            chunkBounds.adjust(-margins.left(),
+                               -margins.top(),
+                               margins.right(),
+                               margins.bottom());
+            chunkBounds.translate(offset);
+
+            if (rect.contains(chunkBounds))
+                continue;
+
+            for (int y = 0; y < CHUNK_SIZE; ++y) {
+                for (int x = 0; x < CHUNK_SIZE; ++x) {
+                    const Cell cell = chunk.cellAt(x, y);
+
+                    if (!cell.isEmpty()) {
+                        QRectF r = cellRect(renderer, cell, chunkStart + QPoint(x, y));
+                        r.translate(offset);
+                        rect |= r;
+                    }
                 }
             }
         }
@@ -127,7 +148,14 @@ static void extendMapRect(QRect &mapBoundingRect, const MapRenderer &renderer)
     mapBoundingRect = rect.toAlignedRect();
 }
 
-void MiniMapRenderer::renderToImage(QImage &image, RenderFlags renderFlags) const
+/**
+ * Renders the map to the given \a image, scaled to fit and centered.
+ *
+ * When an \a exposed rectangle is given, in map pixel coordinates, only that
+ * part of the image is redrawn and the rest of the image is left untouched.
+ */
+void MiniMapRenderer::renderToImage(QImage &image, RenderFlags renderFlags,
+                                    const QRectF &exposed) const
 {
     if (!mMap)
         return;
@@ -154,10 +182,9 @@ void MiniMapRenderer::renderToImage(QImage &image, RenderFlags renderFlags) cons
     const qreal scale = qMin(static_cast<qreal>(image.width()) / mapSize.width(),
                              static_cast<qreal>(image.height()) / mapSize.height());
 
-    if (renderFlags.testFlag(DrawBackground) && mMap->backgroundColor().isValid())
-        image.fill(mMap->backgroundColor());
-    else
-        image.fill(Qt::transparent);
+    const QColor backgroundColor =
+            renderFlags.testFlag(DrawBackground) && mMap->backgroundColor().isValid()
+            ? mMap->backgroundColor() : QColor(Qt::transparent);
 
     QPainter painter(&image);
     painter.setRenderHints(QPainter::SmoothPixmapTransform, renderFlags.testFlag(SmoothPixmapTransform));
@@ -167,10 +194,32 @@ void MiniMapRenderer::renderToImage(QImage &image, RenderFlags renderFlags) cons
     const QPointF centerOffset((image.width() - scaledMapSize.width()) / 2,
                                (image.height() - scaledMapSize.height()) / 2);
 
-    painter.translate(centerOffset);
-    painter.scale(scale, scale);
-    painter.translate(margins.left(), margins.top());
-    painter.translate(-mapBoundingRect.topLeft());
+    QTransform transform;
+    transform.translate(centerOffset.x(), centerOffset.y());
+    transform.scale(scale, scale);
+    transform.translate(margins.left(), margins.top());
+    transform.translate(-mapBoundingRect.left(), -mapBoundingRect.top());
+
+    // Restrict painting to the affected pixels, including those partially
+    // covered due to smooth scaling
+    QRectF exposedRect;
+    if (exposed.isNull()) {
+        image.fill(backgroundColor);
+    } else {
+        const QRect imageRect = transform.mapRect(exposed).toAlignedRect()
+                .adjusted(-1, -1, 1, 1) & image.rect();
+        if (imageRect.isEmpty())
+            return;
+
+        painter.setClipRect(imageRect);
+        painter.setCompositionMode(QPainter::CompositionMode_Source);
+        painter.fillRect(imageRect, backgroundColor);
+        painter.setCompositionMode(QPainter::CompositionMode_SourceOver);
+
+        exposedRect = transform.inverted().mapRect(QRectF(imageRect));
+    }
+
+    painter.setTransform(transform);
 
     mRenderer->setPainterScale(scale);
 
@@ -188,7 +237,7 @@ void MiniMapRenderer::renderToImage(QImage &image, RenderFlags renderFlags) cons
         case Layer::TileLayerType: {
             if (drawTileLayers) {
                 const TileLayer *tileLayer = static_cast<const TileLayer*>(layer);
-                mRenderer->drawTileLayer(&painter, tileLayer);
+                mRenderer->drawTileLayer(&painter, tileLayer, exposedRect.translated(-offset));
             }
             break;
         }
@@ -224,7 +273,7 @@ void MiniMapRenderer::renderToImage(QImage &image, RenderFlags renderFlags) cons
         case Layer::ImageLayerType: {
             if (drawImageLayers) {
                 const ImageLayer *imageLayer = static_cast<const ImageLayer*>(layer);
-                mRenderer->drawImageLayer(&painter, imageLayer);
+                mRenderer->drawImageLayer(&painter, imageLayer, exposedRect.translated(-offset));
             }
             break;
         }
@@ -238,7 +287,9 @@ void MiniMapRenderer::renderToImage(QImage &image, RenderFlags renderFlags) cons
     }
 
     if (drawTileGrid)
-        mRenderer->drawGrid(&painter, mapBoundingRect, mGridColor);
+        mRenderer->drawGrid(&painter, exposed.isNull() ? QRectF(mapBoundingRect)
+                                                       : exposedRect & mapBoundingRect,
+                            mGridColor);
 
     if (drawObjects && mRenderObjectLabelCallback) {
         for (const Layer *layer : mMap->objectGroups()) {
@@ -268,7 +268,7 @@ void OrthogonalRenderer::drawGrid(QPainter *painter, const QRectF &rect,
     }
 }
 
-void OrthogonalRenderer::drawTileLayer(const RenderTileCallback &renderTile,
+void OrthogonalRenderer::drawTileSpans(const RenderSpanCallback &renderSpan,
                                        const QRectF &exposed) const
 {
     const int tileWidth = map()->tileWidth();
@@ -309,9 +309,16 @@ void OrthogonalRenderer::drawTileLayer(const RenderTileCallback &renderTile,
     endX += incX;
     endY += incY;
 
-    for (int y = startY; y != endY; y += incY)
-        for (int x = startX; x != endX; x += incX)
-            renderTile(QPoint(x, y), QPointF(x * tileWidth, (y + 1) * tileHeight));
+    TileSpan span;
+    span.tileStep = QPoint(incX, 0);
+    span.posStep = QPointF(incX * tileWidth, 0);
+    span.count = (endX - startX) * incX;
+
+    for (int y = startY; y != endY; y += incY) {
+        span.startTile = QPoint(startX, y);
+        span.startPos = QPointF(startX * tileWidth, (y + 1) * tileHeight);
+        renderSpan(span);
+    }
 }
 
 void OrthogonalRenderer::drawTileSelection(QPainter *painter,
@@ -52,8 +52,7 @@ public:
     void drawGrid(QPainter *painter, const QRectF &rect,
                   QColor gridColor, QSize gridMajor = QSize()) const override;
 
-    using MapRenderer::drawTileLayer;
-    void drawTileLayer(const RenderTileCallback &renderTile,
+    void drawTileSpans(const RenderSpanCallback &renderSpan,
                        const QRectF &exposed) const override;
 
     void drawTileSelection(QPainter *painter,
@@ -174,6 +174,7 @@ Tile *Tile::clone(Tileset *tileset) const
     Tile *c = new Tile(mImage, mId, tileset);
     c->setProperties(properties());
 
+    c->mImageRect = mImageRect;
     c->mImageSource = mImageSource;
     c->mImageStatus = mImageStatus;
     c->mType = mType;
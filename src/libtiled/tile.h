@@ -74,6 +74,9 @@ public:
     const QPixmap &image() const;
     void setImage(const QPixmap &image);
 
+    const QRect &imageRect() const;
+    void setImageRect(const QRect &imageRect);
+
     const Tile *currentFrameTile() const;
 
     const QUrl &imageSource() const;
@@ -111,6 +114,7 @@ private:
     int mId;
     Tileset *mTileset;
     QPixmap mImage;
+    QRect mImageRect;
     QUrl mImageSource;
     LoadingStatus mImageStatus;
     QString mType;
@@ -154,9 +158,30 @@ inline const QPixmap &Tile::image() const
 inline void Tile::setImage(const QPixmap &image)
 {
     mImage = image;
+    mImageRect = QRect();
     mImageStatus = image.isNull() ? LoadingError : LoadingReady;
 }
 
+/**
+ * Returns the area of the tileset image that contains the image of this
+ * tile. Is a null rect when the tile has no tileset image.
+ *
+ * \sa Tileset::image()
+ */
+inline const QRect &Tile::imageRect() const
+{
+    return mImageRect;
+}
+
+/**
+ * Sets the area of the tileset image that contains the image of this tile.
+ * Should be called after setImage(), which resets the area.
+ */
+inline void Tile::setImageRect(const QRect &imageRect)
+{
+    mImageRect = imageRect;
+}
+
 /**
  * Returns the URL of the external image that represents this tile.
  * When this tile doesn't refer to an external image, an empty URL is
@@ -38,6 +38,8 @@
 
 #include <QSet>
 
+#include "qtcompat_p.h"
+
 using namespace Tiled;
 
 Cell Cell::empty;
@@ -61,35 +63,66 @@ void Cell::rotate(RotateDirection direction)
     setFlippedAntiDiagonally((mask & 1) != 0);
 }
 
-QRegion Chunk::region(std::function<bool (const Cell &)> condition) const
+template<typename Tilesets>
+static QMargins computeDrawMargins(const Tilesets &tilesets)
 {
-    QRegion region;
+    // Not differentiating between width and height, because tiles could be rotated
+    int maxTileSize = 0;
+    QMargins offsetMargins;
 
-    for (int y = 0; y < CHUNK_SIZE; ++y) {
-        for (int x = 0; x < CHUNK_SIZE; ++x) {
-            if (condition(cellAt(x, y))) {
-                const int rangeStart = x;
-                for (++x; x <= CHUNK_SIZE; ++x) {
-                    if (x == CHUNK_SIZE || !condition(cellAt(x, y))) {
-                        const int rangeEnd = x;
-                        region += QRect(rangeStart, y, rangeEnd - rangeStart, 1);
-                        break;
-                    }
-                }
-            }
-        }
+    for (const auto &tileset : tilesets) {
+        if (!tileset)
+            continue;
+
+        const QPoint offset = tileset->tileOffset();
+        const QSize tileSize = tileset->tileSize();
+
+        maxTileSize = std::max(maxTileSize, std::max(tileSize.width(),
+                                                     tileSize.height()));
+
+        offsetMargins = maxMargins(QMargins(-offset.x(),
+                                            -offset.y(),
+                                            offset.x(),
+                                            offset.y()),
+                                   offsetMargins);
     }
 
-    return region;
+    // Adding maxTileSize to top-right of the margins assumes a bottom-left tile
+    // alignment within the grid cell.
+    return QMargins(offsetMargins.left(),
+                    offsetMargins.top() + maxTileSize,
+                    offsetMargins.right() + maxTileSize,
+                    offsetMargins.bottom());
 }
 
 void Chunk::setCell(int x, int y, const Cell &cell)
 {
     int index = x + y * CHUNK_SIZE;
 
+    expand();
+    if (!mPaletteDirty)
+        replacePaletteEntry(mGrid.at(index)._tileset, cell._tileset);
     mGrid[index] = cell;
 }
 
+/**
+ * Sets \a count cells on row \a y, starting at \a x. The cells need to fit
+ * within the chunk.
+ */
+void Chunk::setCells(int x, int y, const Cell *cells, int count)
+{
+    Q_ASSERT(x >= 0 && x + count <= CHUNK_SIZE);
+
+    expand();
+
+    const int index = x + y * CHUNK_SIZE;
+    if (!mPaletteDirty)
+        for (int i = 0; i < count; ++i)
+            replacePaletteEntry(mGrid.at(index + i)._tileset, cells[i]._tileset);
+
+    std::copy(cells, cells + count, mGrid.begin() + index);
+}
+
 bool Chunk::isEmpty() const
 {
     for (int y = 0; y < CHUNK_SIZE; ++y) {
@@ -104,8 +137,8 @@ bool Chunk::isEmpty() const
 
 bool Chunk::hasCell(std::function<bool (const Cell &)> condition) const
 {
-    for (const Cell &cell : mGrid)
-        if (condition(cell))
+    for (int i = 0; i < CHUNK_SIZE * CHUNK_SIZE; ++i)
+        if (condition(cellAtIndex(i)))
             return true;
 
     return false;
@@ -113,59 +146,186 @@ bool Chunk::hasCell(std::function<bool (const Cell &)> condition) const
 
 void Chunk::removeReferencesToTileset(Tileset *tileset)
 {
+    if (isCompact() && !mPalette.contains(tileset))
+        return;
+
+    expand();
+
     for (int i = 0, i_end = mGrid.size(); i < i_end; ++i) {
         if (mGrid.at(i).tileset() == tileset)
             mGrid.replace(i, Cell::empty);
     }
+
+    rebuildPalette();
 }
 
 void Chunk::replaceReferencesToTileset(Tileset *oldTileset, Tileset *newTileset)
 {
+    if (isCompact()) {
+        std::replace(mPalette.begin(), mPalette.end(), oldTileset, newTileset);
+        return;
+    }
+
     for (Cell &cell : mGrid) {
         if (cell.tileset() == oldTileset)
             cell.setTile(newTileset, cell.tileId());
     }
+
+    rebuildPalette();
 }
 
-TileLayer::TileLayer(const QString &name, int x, int y, int width, int height)
-    : Layer(TileLayerType, name, x, y)
-    , mWidth(width)
-    , mHeight(height)
-    , mUsedTilesetsDirty(false)
+/**
+ * Returns the tilesets referenced by the cells of this chunk, which includes
+ * nullptr when the chunk has empty cells.
+ *
+ * This doesn't modify the chunk, so it is safe to call from multiple threads
+ * as long as the chunk isn't modified at the same time.
+ */
+QVector<Tileset*> Chunk::tilesets() const
 {
+    if (!mPaletteDirty)
+        return mPalette;
+
+    // Cells may have been changed through the iterators
+    QVector<Tileset*> tilesets;
+    for (const Cell &cell : mGrid)
+        if (!tilesets.contains(cell._tileset))
+            tilesets.append(cell._tileset);
+
+    return tilesets;
 }
 
-TileLayer::TileLayer(const QString &name, QPoint position, QSize size)
-    : TileLayer(name, position.x(), position.y(), size.width(), size.height())
+/**
+ * Updates the palette of an expanded chunk for a cell changing from
+ * \a oldTileset to \a newTileset. Should not be called while the palette
+ * is dirty.
+ */
+void Chunk::replacePaletteEntry(Tileset *oldTileset, Tileset *newTileset)
 {
+    if (oldTileset == newTileset)
+        return;
+
+    const int oldIndex = mPalette.indexOf(oldTileset);
+    Q_ASSERT(oldIndex != -1);
+    if (--mPaletteCounts[oldIndex] == 0) {
+        mPalette.remove(oldIndex);
+        mPaletteCounts.remove(oldIndex);
+    }
+
+    const int newIndex = mPalette.indexOf(newTileset);
+    if (newIndex == -1) {
+        mPalette.append(newTileset);
+        mPaletteCounts.append(1);
+    } else {
+        ++mPaletteCounts[newIndex];
+    }
 }
 
-static QMargins computeDrawMargins(const QSet<SharedTileset> &tilesets)
+/**
+ * Determines the palette and the number of cells using each tileset from
+ * the cells of an expanded chunk.
+ */
+void Chunk::rebuildPalette()
 {
-    // Not differentiating between width and height, because tiles could be rotated
-    int maxTileSize = 0;
-    QMargins offsetMargins;
+    mPalette.clear();
+    mPaletteCounts.clear();
+
+    for (const Cell &cell : qAsConst(mGrid)) {
+        const int index = mPalette.indexOf(cell._tileset);
+        if (index == -1) {
+            mPalette.append(cell._tileset);
+            mPaletteCounts.append(1);
+        } else {
+            ++mPaletteCounts[index];
+        }
+    }
 
-    for (const SharedTileset &tileset : tilesets) {
-        const QPoint offset = tileset->tileOffset();
-        const QSize tileSize = tileset->tileSize();
+    mPaletteDirty = false;
+}
 
-        maxTileSize = std::max(maxTileSize, std::max(tileSize.width(),
-                                                     tileSize.height()));
+/**
+ * Computes the extent by which the tiles in this chunk may extend beyond
+ * their cells, like TileLayer::drawMargins().
+ */
+QMargins Chunk::drawMargins() const
+{
+    return computeDrawMargins(tilesets());
+}
 
-        offsetMargins = maxMargins(QMargins(-offset.x(),
-                                            -offset.y(),
-                                            offset.x(),
-                                            offset.y()),
-                                   offsetMargins);
+/**
+ * Packs the cells of this chunk into their compact form. Returns false when
+ * a cell can't be represented, in which case the chunk is left as is.
+ */
+bool Chunk::compact()
+{
+    if (isCompact())
+        return true;
+
+    // Brings the palette up to date in case the chunk can't be packed
+    if (mPaletteDirty)
+        rebuildPalette();
+
+    QVector<quint32> packed(CHUNK_SIZE * CHUNK_SIZE);
+    QVector<Tileset*> palette;
+
+    for (int i = 0; i < CHUNK_SIZE * CHUNK_SIZE; ++i) {
+        const Cell &cell = mGrid.at(i);
+        if (cell._tileId < -1 || cell._tileId > MaxTileId || (cell._flags & ~FlagMask))
+            return false;
+
+        int paletteIndex = palette.indexOf(cell._tileset);
+        if (paletteIndex == -1) {
+            if (palette.size() == MaxPaletteSize)
+                return false;
+
+            paletteIndex = palette.size();
+            palette.append(cell._tileset);
+        }
+
+        packed[i] = (static_cast<quint32>(cell._tileId + 1) << TileIdShift) |
+                (static_cast<quint32>(paletteIndex) << FlagBits) |
+                static_cast<quint32>(cell._flags);
     }
 
-    // Adding maxTileSize to top-right of the margins assumes a bottom-left tile
-    // alignment within the grid cell.
-    return QMargins(offsetMargins.left(),
-                    offsetMargins.top() + maxTileSize,
-                    offsetMargins.right() + maxTileSize,
-                    offsetMargins.bottom());
+    mPacked.swap(packed);
+    mPalette.swap(palette);
+    mPaletteCounts = QVector<int>();
+    mPaletteDirty = false;
+    mGrid = QVector<Cell>();    // release the memory
+    return true;
+}
+
+/**
+ * Unpacks the cells of a compact chunk, so that they can be modified.
+ */
+void Chunk::expand()
+{
+    if (!isCompact())
+        return;
+
+    QVector<Cell> grid;
+    grid.reserve(CHUNK_SIZE * CHUNK_SIZE);
+    for (int i = 0; i < CHUNK_SIZE * CHUNK_SIZE; ++i)
+        grid.append(cellAtIndex(i));
+
+    mGrid.swap(grid);
+    mPacked = QVector<quint32>();
+
+    // Also merges any duplicate entries left by replacing a tileset
+    rebuildPalette();
+}
+
+TileLayer::TileLayer(const QString &name, int x, int y, int width, int height)
+    : Layer(TileLayerType, name, x, y)
+    , mWidth(width)
+    , mHeight(height)
+    , mUsedTilesetsDirty(false)
+{
+}
+
+TileLayer::TileLayer(const QString &name, QPoint position, QSize size)
+    : TileLayer(name, position.x(), position.y(), size.width(), size.height())
+{
 }
 
 QMargins TileLayer::drawMargins() const
@@ -179,13 +339,33 @@ QMargins TileLayer::drawMargins() const
  */
 QRegion TileLayer::region(std::function<bool (const Cell &)> condition) const
 {
-    QRegion region;
+    return tileRegion(std::move(condition)).toRegion();
+}
 
-    QHashIterator<QPoint, Chunk> it(mChunks);
-    while (it.hasNext()) {
-        it.next();
-        region += it.value().region(condition).translated(it.key().x() * CHUNK_SIZE + mX,
-                                                          it.key().y() * CHUNK_SIZE + mY);
+/**
+ * Calculates the region of cells in this tile layer for which the given
+ * \a condition returns true, as a TileRegion.
+ */
+TileRegion TileLayer::tileRegion(std::function<bool (const Cell &)> condition) const
+{
+    static_assert(CHUNK_SIZE <= 64, "Chunk rows need to fit in a 64-bit mask");
+
+    TileRegion region;
+
+    for (auto it = mChunks.begin(), end = mChunks.end(); it != end; ++it) {
+        const Chunk &chunk = it.value();
+        const int chunkX = it.key().x() * CHUNK_SIZE + mX;
+        const int chunkY = it.key().y() * CHUNK_SIZE + mY;
+
+        for (int y = 0; y < CHUNK_SIZE; ++y) {
+            quint64 mask = 0;
+            for (int x = 0; x < CHUNK_SIZE; ++x)
+                if (condition(chunk.cellAt(x, y)))
+                    mask |= quint64(1) << x;
+
+            if (mask)
+                region.addRow(chunkX, chunkY + y, mask);
+        }
     }
 
     return region;
@@ -223,6 +403,65 @@ void Tiled::TileLayer::setCell(int x, int y, const Cell &cell)
     _chunk.setCell(x & CHUNK_MASK, y & CHUNK_MASK, cell);
 }
 
+/**
+ * Sets \a count cells on row \a y, starting at \a x, to the given \a cells.
+ *
+ * This is equivalent to calling setCell() for each of the cells, but looks up
+ * each affected chunk only once.
+ */
+void TileLayer::setCellRow(int x, int y, const Cell *cells, int count)
+{
+    const Tileset *lastAddedTileset = nullptr;
+
+    while (count > 0) {
+        const int chunkX = x & CHUNK_MASK;
+        const int chunkY = y & CHUNK_MASK;
+        const int segment = std::min(count, CHUNK_SIZE - chunkX);
+
+        if (!findChunk(x, y)) {
+            const bool hasContent = std::any_of(cells, cells + segment, [] (const Cell &cell) {
+                return cell != Cell::empty || cell.checked();
+            });
+
+            if (!hasContent) {
+                x += segment;
+                cells += segment;
+                count -= segment;
+                continue;
+            }
+
+            mBounds = mBounds.united(QRect(x - chunkX,
+                                           y - chunkY,
+                                           CHUNK_SIZE,
+                                           CHUNK_SIZE));
+        }
+
+        Chunk &_chunk = chunk(x, y);
+
+        if (!mUsedTilesetsDirty) {
+            for (int i = 0; i < segment; ++i) {
+                Tileset *oldTileset = _chunk.cellAt(chunkX + i, chunkY).tileset();
+                Tileset *newTileset = cells[i].tileset();
+                if (oldTileset != newTileset) {
+                    if (oldTileset) {
+                        mUsedTilesetsDirty = true;
+                        break;
+                    } else if (newTileset && newTileset != lastAddedTileset) {
+                        mUsedTilesets.insert(newTileset->sharedFromThis());
+                        lastAddedTileset = newTileset;
+                    }
+                }
+            }
+        }
+
+        _chunk.setCells(chunkX, chunkY, cells, segment);
+
+        x += segment;
+        cells += segment;
+        count -= segment;
+    }
+}
+
 std::unique_ptr<TileLayer> TileLayer::copy(const QRegion &region) const
 {
     const QRect regionBounds = region.boundingRect();
@@ -278,6 +517,46 @@ void TileLayer::setCells(int x, int y, const TileLayer *layer,
                 setCell(_x, _y, layer->cellAt(_x - x, _y - y));
 }
 
+void TileLayer::snapshotChunks(const TileLayer &tileLayer, const QRegion &region)
+{
+    // Shared by all snapshots of chunks that didn't exist yet
+    static const Chunk emptyChunk = [] {
+        Chunk chunk;
+        chunk.compact();
+        return chunk;
+    }();
+
+#if QT_VERSION < 0x050800
+    const auto rects = region.rects();
+    for (const QRect &rect : rects) {
+#else
+    for (const QRect &rect : region) {
+#endif
+        for (int y = rect.top() >> CHUNK_BITS; y <= rect.bottom() >> CHUNK_BITS; ++y) {
+            for (int x = rect.left() >> CHUNK_BITS; x <= rect.right() >> CHUNK_BITS; ++x) {
+                const QPoint chunkCoordinates(x, y);
+                if (mChunks.contains(chunkCoordinates))
+                    continue;
+
+                auto it = tileLayer.mChunks.find(chunkCoordinates);
+                if (it == tileLayer.mChunks.end()) {
+                    mChunks.insert(chunkCoordinates, emptyChunk);
+                    continue;
+                }
+
+                // Compacting the copy releases its reference to an expanded
+                // grid, so the source layer can keep modifying it in place.
+                Chunk &chunk = mChunks.insert(chunkCoordinates, it.value()).value();
+                chunk.compact();
+
+                mBounds = mBounds.united(QRect(x * CHUNK_SIZE, y * CHUNK_SIZE,
+                                               CHUNK_SIZE, CHUNK_SIZE));
+                mUsedTilesetsDirty = true;
+            }
+        }
+    }
+}
+
 /**
  * Sets the tiles in the given \a area to \a tile. Flipping flags are
  * preserved.
@@ -570,8 +849,8 @@ QSet<SharedTileset> TileLayer::usedTilesets() const
         QSet<SharedTileset> tilesets;
 
         for (const Chunk &chunk : mChunks) {
-            for (const Cell &cell : chunk)
-                if (const Tile *tile = cell.tile())
+            for (int i = 0; i < CHUNK_SIZE * CHUNK_SIZE; ++i)
+                if (const Tile *tile = chunk.cellAtIndex(i).tile())
                     tilesets.insert(tile->sharedTileset());
         }
 
@@ -597,6 +876,12 @@ bool TileLayer::referencesTileset(const Tileset *tileset) const
     return ::contains(usedTilesets(), tileset);
 }
 
+void TileLayer::compact()
+{
+    for (Chunk &chunk : mChunks)
+        chunk.compact();
+}
+
 void TileLayer::removeReferencesToTileset(Tileset *tileset)
 {
     for (Chunk &chunk : mChunks)
@@ -32,8 +32,10 @@
 #include "tiled_global.h"
 
 #include "layer.h"
+#include "pointhash.h"
 #include "tiled.h"
 #include "tile.h"
+#include "tileregion.h"
 #include "tileset.h"
 
 #include <QHash>
@@ -45,15 +47,6 @@
 
 #include <functional>
 
-#if QT_VERSION < QT_VERSION_CHECK(6, 0, 0)
-inline uint qHash(QPoint key, uint seed = 0) Q_DECL_NOTHROW
-{
-    uint h1 = qHash(key.x(), seed);
-    uint h2 = qHash(key.y(), seed);
-    return ((h1 << 16) | (h1 >> 16)) ^ h2 ^ seed;
-}
-#endif
-
 namespace Tiled {
 
 class Tile;
@@ -131,6 +124,8 @@ public:
     bool refersTile(const Tile *tile) const;
 
 private:
+    friend class Chunk;
+
     enum Flags {
         FlippedHorizontally     = 0x01,
         FlippedVertically       = 0x02,
@@ -172,20 +167,26 @@ inline bool Cell::refersTile(const Tile *tile) const
 
 /**
  * A Chunk is a grid of cells of size CHUNK_SIZExCHUNK_SIZE.
+ *
+ * A chunk can be stored in a compact form, where each cell is packed into
+ * 32 bits that refer to a small palette of the tilesets used in the chunk.
+ * Reading cells works the same in either form, while modifying a compact
+ * chunk expands it again.
  */
 class TILEDSHARED_EXPORT Chunk
 {
 public:
     Chunk() :
-        mGrid(CHUNK_SIZE * CHUNK_SIZE)
+        mGrid(CHUNK_SIZE * CHUNK_SIZE),
+        mPalette(1, nullptr),
+        mPaletteCounts(1, CHUNK_SIZE * CHUNK_SIZE)
     {}
 
-    QRegion region(std::function<bool (const Cell &)> condition) const;
-
-    const Cell &cellAt(int x, int y) const;
-    const Cell &cellAt(QPoint point) const;
+    Cell cellAt(int x, int y) const;
+    Cell cellAt(QPoint point) const;
 
     void setCell(int x, int y, const Cell &cell);
+    void setCells(int x, int y, const Cell *cells, int count);
 
     bool isEmpty() const;
 
@@ -195,21 +196,63 @@ public:
 
     void replaceReferencesToTileset(Tileset *oldTileset, Tileset *newTileset);
 
-    QVector<Cell>::iterator begin() { return mGrid.begin(); }
-    QVector<Cell>::iterator end() { return mGrid.end(); }
-    QVector<Cell>::const_iterator begin() const { return mGrid.begin(); }
-    QVector<Cell>::const_iterator end() const { return mGrid.end(); }
+    QVector<Tileset*> tilesets() const;
+    QMargins drawMargins() const;
+
+    bool isCompact() const { return !mPacked.isEmpty(); }
+    bool compact();
+    void expand();
+
+    // Cells modified through these iterators aren't tracked, so the palette
+    // is marked dirty and only rebuilt when needed
+    QVector<Cell>::iterator begin() { expand(); mPaletteDirty = true; return mGrid.begin(); }
+    QVector<Cell>::iterator end() { expand(); mPaletteDirty = true; return mGrid.end(); }
 
 private:
-    QVector<Cell> mGrid;
+    friend class TileLayer;
+
+    // Layout of a packed cell: flags, palette index and tile ID + 1
+    static constexpr int FlagBits = 5;
+    static constexpr int PaletteBits = 8;
+    static constexpr int TileIdShift = FlagBits + PaletteBits;
+    static constexpr quint32 FlagMask = (1u << FlagBits) - 1;
+    static constexpr quint32 PaletteMask = (1u << PaletteBits) - 1;
+    static constexpr int MaxPaletteSize = 1 << PaletteBits;
+    static constexpr int MaxTileId = (1 << (32 - TileIdShift)) - 2;
+
+    Cell cellAtIndex(int index) const;
+    void replacePaletteEntry(Tileset *oldTileset, Tileset *newTileset);
+    void rebuildPalette();
+
+    QVector<Cell> mGrid;            // empty while compact
+    QVector<quint32> mPacked;       // empty unless compact
+
+    // The tilesets used by the chunk. While expanded, the number of cells
+    // using each of them is kept as well, so that the palette can be kept
+    // up to date when cells change.
+    QVector<Tileset*> mPalette;
+    QVector<int> mPaletteCounts;    // empty while compact
+    bool mPaletteDirty = false;
 };
 
-inline const Cell &Chunk::cellAt(int x, int y) const
+inline Cell Chunk::cellAtIndex(int index) const
 {
-    return mGrid.at(x + y * CHUNK_SIZE);
+    if (!isCompact())
+        return mGrid.at(index);
+
+    const quint32 value = mPacked.at(index);
+    Cell cell(mPalette.at((value >> FlagBits) & PaletteMask),
+              static_cast<int>(value >> TileIdShift) - 1);
+    cell._flags = value & FlagMask;
+    return cell;
 }
 
-inline const Cell &Chunk::cellAt(QPoint point) const
+inline Cell Chunk::cellAt(int x, int y) const
+{
+    return cellAtIndex(x + y * CHUNK_SIZE);
+}
+
+inline Cell Chunk::cellAt(QPoint point) const
 {
     return cellAt(point.x(), point.y());
 }
@@ -232,7 +275,7 @@ public:
             , mChunkEndPointer(end)
         {
             if (it != end)
-                mCellPointer = it.value().begin();
+                enterChunk();
         }
 
         iterator operator++(int)
@@ -273,10 +316,13 @@ public:
         QPoint key() const;
 
     private:
+        void enterChunk();
         void advance();
 
         QHash<QPoint, Chunk>::iterator mChunkPointer;
         QHash<QPoint, Chunk>::iterator mChunkEndPointer;
+        QVector<Cell>::iterator mChunkBegin;
+        QVector<Cell>::iterator mChunkEnd;
         QVector<Cell>::iterator mCellPointer;
     };
 
@@ -286,10 +332,7 @@ public:
         const_iterator(QHash<QPoint, Chunk>::const_iterator it, QHash<QPoint, Chunk>::const_iterator end)
             : mChunkPointer(it)
             , mChunkEndPointer(end)
-        {
-            if (it != end)
-                mCellPointer = it.value().begin();
-        }
+        {}
 
         const_iterator operator++(int)
         {
@@ -304,27 +347,22 @@ public:
             return *this;
         }
 
-        const Cell &operator*() { return *mCellPointer; }
-
-        QVector<Cell>::const_iterator operator->() const { return mCellPointer; }
+        Cell operator*() const { return value(); }
 
         friend bool operator==(const const_iterator& lhs, const const_iterator& rhs)
         {
             if (lhs.mChunkPointer == lhs.mChunkEndPointer || rhs.mChunkPointer == rhs.mChunkEndPointer)
                 return lhs.mChunkPointer == rhs.mChunkPointer;
             else
-                return lhs.mCellPointer == rhs.mCellPointer;
+                return lhs.mChunkPointer == rhs.mChunkPointer && lhs.mIndex == rhs.mIndex;
         }
 
         friend bool operator!=(const const_iterator& lhs, const const_iterator& rhs)
         {
-            if (lhs.mChunkPointer == lhs.mChunkEndPointer || rhs.mChunkPointer == rhs.mChunkEndPointer)
-                return lhs.mChunkPointer != rhs.mChunkPointer;
-            else
-                return lhs.mCellPointer != rhs.mCellPointer;
+            return !(lhs == rhs);
         }
 
-        const Cell &value() const { return *mCellPointer; }
+        Cell value() const { return mChunkPointer.value().cellAtIndex(mIndex); }
 
         QPoint key() const;
 
@@ -333,7 +371,7 @@ public:
 
         QHash<QPoint, Chunk>::const_iterator mChunkPointer;
         QHash<QPoint, Chunk>::const_iterator mChunkEndPointer;
-        QVector<Cell>::const_iterator mCellPointer;
+        int mIndex = 0;
     };
 
     /**
@@ -376,6 +414,8 @@ public:
 
     QMargins drawMargins() const;
 
+    const QHash<QPoint, Chunk> &chunks() const;
+
     bool contains(int x, int y) const;
     bool contains(QPoint point) const;
 
@@ -386,10 +426,17 @@ public:
     QRegion region(std::function<bool (const Cell &)> condition) const;
     QRegion region() const;
 
-    const Cell &cellAt(int x, int y) const;
-    const Cell &cellAt(QPoint point) const;
+    TileRegion tileRegion(std::function<bool (const Cell &)> condition) const;
+    TileRegion tileRegion() const;
+
+    Cell cellAt(int x, int y) const;
+    Cell cellAt(QPoint point) const;
+
+    template<typename Function>
+    void forEachCell(QPoint start, QPoint step, int count, Function function) const;
 
     void setCell(int x, int y, const Cell &cell);
+    void setCellRow(int x, int y, const Cell *cells, int count);
 
     /**
      * Returns a copy of the area specified by the given \a region. The
@@ -426,6 +473,17 @@ public:
      */
     void setCells(int x, int y, const TileLayer *tileLayer);
 
+    /**
+     * Makes this layer refer to the chunks of \a tileLayer that intersect the
+     * given \a region, which is a cheap way of taking a snapshot of the
+     * region since the storage of a chunk is only copied when modified.
+     *
+     * Chunks already present in this layer are kept, and chunks that are
+     * missing from \a tileLayer are stored as empty chunks. The snapshot is
+     * compacted where possible.
+     */
+    void snapshotChunks(const TileLayer &tileLayer, const QRegion &region);
+
     void setTiles(const QRegion &area, Tile *tile);
 
     /**
@@ -525,6 +583,13 @@ public:
 
     TileLayer *clone() const override;
 
+    /**
+     * Stores the chunks of this layer in compact form where possible, which
+     * reduces the memory used by this layer to about a quarter. Chunks are
+     * expanded again as soon as they are modified.
+     */
+    void compact();
+
     iterator begin() { return iterator(mChunks.begin(), mChunks.end()); }
     iterator end() { return iterator(mChunks.end(), mChunks.end()); }
     const_iterator begin() const { return const_iterator(mChunks.begin(), mChunks.end()); }
@@ -548,19 +613,30 @@ inline QPoint TileLayer::iterator::key() const
 {
     QPoint chunkStart = mChunkPointer.key();
 
-    int index = mCellPointer - mChunkPointer.value().begin();
+    int index = mCellPointer - mChunkBegin;
     chunkStart += QPoint(index & CHUNK_MASK, index / CHUNK_SIZE);
 
     return chunkStart;
 }
 
+/**
+ * Expands the current chunk once and remembers its range of cells, since
+ * Chunk::begin() marks the palette of the chunk as dirty.
+ */
+inline void TileLayer::iterator::enterChunk()
+{
+    mChunkBegin = mChunkPointer.value().begin();
+    mChunkEnd = mChunkBegin + CHUNK_SIZE * CHUNK_SIZE;
+    mCellPointer = mChunkBegin;
+}
+
 inline void TileLayer::iterator::advance()
 {
     if (mChunkPointer != mChunkEndPointer) {
-        if (++mCellPointer == mChunkPointer.value().end()) {
+        if (++mCellPointer == mChunkEnd) {
             mChunkPointer++;
             if (mChunkPointer != mChunkEndPointer)
-                mCellPointer = mChunkPointer.value().begin();
+                enterChunk();
         }
     }
 }
@@ -569,8 +645,7 @@ inline QPoint TileLayer::const_iterator::key() const
 {
     QPoint chunkStart = mChunkPointer.key();
 
-    int index = mCellPointer - mChunkPointer.value().begin();
-    chunkStart += QPoint(index & CHUNK_MASK, index / CHUNK_SIZE);
+    chunkStart += QPoint(mIndex & CHUNK_MASK, mIndex / CHUNK_SIZE);
 
     return chunkStart;
 }
@@ -578,10 +653,9 @@ inline QPoint TileLayer::const_iterator::key() const
 inline void TileLayer::const_iterator::advance()
 {
     if (mChunkPointer != mChunkEndPointer) {
-        if (++mCellPointer == mChunkPointer.value().end()) {
+        if (++mIndex == CHUNK_SIZE * CHUNK_SIZE) {
             mChunkPointer++;
-            if (mChunkPointer != mChunkEndPointer)
-                mCellPointer = mChunkPointer.value().begin();
+            mIndex = 0;
         }
     }
 }
@@ -605,6 +679,14 @@ inline bool TileLayer::contains(QPoint point) const
     return contains(point.x(), point.y());
 }
 
+/**
+ * Returns the chunks of this layer, by their chunk coordinates.
+ */
+inline const QHash<QPoint, Chunk> &TileLayer::chunks() const
+{
+    return mChunks;
+}
+
 inline Chunk& TileLayer::chunk(int x, int y)
 {
     const QPoint chunkCoordinates(x >> CHUNK_BITS, y >> CHUNK_BITS);
@@ -628,10 +710,19 @@ inline QRegion TileLayer::region() const
 }
 
 /**
- * Returns a read-only reference to the cell at the given coordinates. The
- * coordinates have to be within this layer.
+ * Calculates the region occupied by the tiles of this layer, like region(),
+ * but as a TileRegion.
  */
-inline const Cell &TileLayer::cellAt(int x, int y) const
+inline TileRegion TileLayer::tileRegion() const
+{
+    return tileRegion([] (const Cell &cell) { return !cell.isEmpty(); });
+}
+
+/**
+ * Returns the cell at the given coordinates. The coordinates have to be
+ * within this layer.
+ */
+inline Cell TileLayer::cellAt(int x, int y) const
 {
     if (const Chunk *chunk = findChunk(x, y))
         return chunk->cellAt(x & CHUNK_MASK, y & CHUNK_MASK);
@@ -639,11 +730,42 @@ inline const Cell &TileLayer::cellAt(int x, int y) const
         return Cell::empty;
 }
 
-inline const Cell &TileLayer::cellAt(QPoint point) const
+inline Cell TileLayer::cellAt(QPoint point) const
 {
     return cellAt(point.x(), point.y());
 }
 
+/**
+ * Calls \a function for each non-empty cell among the \a count cells
+ * starting at \a start and advancing by \a step, passing the index of the
+ * cell and the cell itself.
+ *
+ * This is faster than calling cellAt() for each cell, since the chunk is only
+ * looked up again when moving into another one.
+ */
+template<typename Function>
+inline void TileLayer::forEachCell(QPoint start, QPoint step, int count, Function function) const
+{
+    QPoint pos = start;
+    QPoint chunkCoordinates(pos.x() >> CHUNK_BITS, pos.y() >> CHUNK_BITS);
+    const Chunk *chunk = findChunk(pos.x(), pos.y());
+
+    for (int index = 0; index < count; ++index, pos += step) {
+        const QPoint coordinates(pos.x() >> CHUNK_BITS, pos.y() >> CHUNK_BITS);
+        if (coordinates != chunkCoordinates) {
+            chunkCoordinates = coordinates;
+            chunk = findChunk(pos.x(), pos.y());
+        }
+
+        if (!chunk)
+            continue;
+
+        const Cell cell = chunk->cellAt(pos.x() & CHUNK_MASK, pos.y() & CHUNK_MASK);
+        if (!cell.isEmpty())
+            function(index, cell);
+    }
+}
+
 inline void TileLayer::setCells(int x, int y, const TileLayer *tileLayer)
 {
     setCells(x, y, tileLayer,
@@ -0,0 +1,371 @@
+/*
+ * tileregion.cpp
+ * Copyright 2026, agent <agent@local>
+ *
+ * This file is part of libtiled.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *    1. Redistributions of source code must retain the above copyright notice,
+ *       this list of conditions and the following disclaimer.
+ *
+ *    2. Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE CONTRIBUTORS ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO
+ * EVENT SHALL THE CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+ * ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "tileregion.h"
+
+#include <QtAlgorithms>
+
+#include <algorithm>
+#include <cstring>
+
+namespace Tiled {
+
+/**
+ * Returns a mask with the bits \a first up to and including \a last set.
+ */
+static quint64 bitRange(int first, int last)
+{
+    const quint64 upTo = last == TileRegion::BlockMask ? ~quint64(0)
+                                                       : (quint64(1) << (last + 1)) - 1;
+    return upTo & ~((quint64(1) << first) - 1);
+}
+
+bool TileRegion::Block::isEmpty() const
+{
+    for (quint64 bits : rows)
+        if (bits)
+            return false;
+    return true;
+}
+
+TileRegion::TileRegion(const QRect &rect)
+{
+    add(rect);
+}
+
+TileRegion::TileRegion(const QRegion &region)
+{
+#if QT_VERSION < 0x050800
+    const auto rects = region.rects();
+    for (const QRect &rect : rects)
+#else
+    for (const QRect &rect : region)
+#endif
+        add(rect);
+}
+
+bool TileRegion::intersects(const TileRegion &other) const
+{
+    if (other.mBlocks.size() < mBlocks.size())
+        return other.intersects(*this);
+
+    for (auto it = mBlocks.begin(), end = mBlocks.end(); it != end; ++it) {
+        auto otherIt = other.mBlocks.find(it.key());
+        if (otherIt == other.mBlocks.end())
+            continue;
+
+        for (int y = 0; y < BlockSize; ++y)
+            if (it.value().rows[y] & otherIt.value().rows[y])
+                return true;
+    }
+
+    return false;
+}
+
+QRect TileRegion::boundingRect() const
+{
+    QRect bounds;
+
+    for (auto it = mBlocks.begin(), end = mBlocks.end(); it != end; ++it) {
+        const Block &block = it.value();
+        int top = -1, bottom = -1;
+        int left = BlockSize, right = -1;
+
+        for (int y = 0; y < BlockSize; ++y) {
+            const quint64 bits = block.rows[y];
+            if (!bits)
+                continue;
+
+            if (top == -1)
+                top = y;
+            bottom = y;
+            left = std::min<int>(left, qCountTrailingZeroBits(bits));
+            right = std::max<int>(right, BlockMask - qCountLeadingZeroBits(bits));
+        }
+
+        const QPoint origin = it.key() * BlockSize;
+        bounds |= QRect(origin + QPoint(left, top), origin + QPoint(right, bottom));
+    }
+
+    return bounds;
+}
+
+/**
+ * Returns the number of tiles in this region.
+ */
+int TileRegion::count() const
+{
+    int count = 0;
+    for (const Block &block : mBlocks)
+        for (quint64 bits : block.rows)
+            count += qPopulationCount(bits);
+    return count;
+}
+
+/**
+ * Adds the tiles within the given \a rect.
+ */
+void TileRegion::add(const QRect &rect)
+{
+    if (rect.isEmpty())
+        return;
+
+    for (int blockY = rect.top() >> BlockBits; blockY <= rect.bottom() >> BlockBits; ++blockY) {
+        const int top = std::max(rect.top() - blockY * BlockSize, 0);
+        const int bottom = std::min(rect.bottom() - blockY * BlockSize, int(BlockMask));
+
+        for (int blockX = rect.left() >> BlockBits; blockX <= rect.right() >> BlockBits; ++blockX) {
+            const int left = std::max(rect.left() - blockX * BlockSize, 0);
+            const int right = std::min(rect.right() - blockX * BlockSize, int(BlockMask));
+            const quint64 bits = bitRange(left, right);
+
+            Block &block = mBlocks[QPoint(blockX, blockY)];
+            for (int y = top; y <= bottom; ++y)
+                block.rows[y] |= bits;
+        }
+    }
+}
+
+/**
+ * Adds the tiles at (\a x + i, \a y) for each bit i that is set in \a mask.
+ */
+void TileRegion::addRow(int x, int y, quint64 mask)
+{
+    const int shift = x & BlockMask;
+
+    if (const quint64 bits = mask << shift)
+        row(x, y) |= bits;
+    if (shift > 0)
+        if (const quint64 bits = mask >> (BlockSize - shift))
+            row(x + BlockSize, y) |= bits;
+}
+
+TileRegion TileRegion::translated(QPoint offset) const
+{
+    if (!(offset.x() & BlockMask) && !(offset.y() & BlockMask)) {
+        const QPoint blockOffset(offset.x() >> BlockBits, offset.y() >> BlockBits);
+
+        TileRegion result;
+        for (auto it = mBlocks.begin(), end = mBlocks.end(); it != end; ++it)
+            result.mBlocks.insert(it.key() + blockOffset, it.value());
+        return result;
+    }
+
+    TileRegion result;
+    for (auto it = mBlocks.begin(), end = mBlocks.end(); it != end; ++it) {
+        const QPoint origin = it.key() * BlockSize + offset;
+        for (int y = 0; y < BlockSize; ++y)
+            if (const quint64 bits = it.value().rows[y])
+                result.addRow(origin.x(), origin.y() + y, bits);
+    }
+    return result;
+}
+
+TileRegion &TileRegion::operator|=(const TileRegion &other)
+{
+    if (isEmpty())
+        return *this = other;
+
+    for (auto it = other.mBlocks.begin(), end = other.mBlocks.end(); it != end; ++it) {
+        Block &block = mBlocks[it.key()];
+        for (int y = 0; y < BlockSize; ++y)
+            block.rows[y] |= it.value().rows[y];
+    }
+    return *this;
+}
+
+TileRegion &TileRegion::operator&=(const TileRegion &other)
+{
+    for (auto it = mBlocks.begin(); it != mBlocks.end();) {
+        auto otherIt = other.mBlocks.find(it.key());
+        if (otherIt == other.mBlocks.end()) {
+            it = mBlocks.erase(it);
+            continue;
+        }
+
+        Block &block = it.value();
+        for (int y = 0; y < BlockSize; ++y)
+            block.rows[y] &= otherIt.value().rows[y];
+
+        if (block.isEmpty())
+            it = mBlocks.erase(it);
+        else
+            ++it;
+    }
+    return *this;
+}
+
+TileRegion &TileRegion::operator-=(const TileRegion &other)
+{
+    for (auto it = other.mBlocks.begin(), end = other.mBlocks.end(); it != end; ++it) {
+        auto ownIt = mBlocks.find(it.key());
+        if (ownIt == mBlocks.end())
+            continue;
+
+        Block &block = ownIt.value();
+        for (int y = 0; y < BlockSize; ++y)
+            block.rows[y] &= ~it.value().rows[y];
+
+        if (block.isEmpty())
+            mBlocks.erase(ownIt);
+    }
+    return *this;
+}
+
+TileRegion &TileRegion::operator^=(const TileRegion &other)
+{
+    for (auto it = other.mBlocks.begin(), end = other.mBlocks.end(); it != end; ++it) {
+        auto ownIt = mBlocks.find(it.key());
+        if (ownIt == mBlocks.end()) {
+            mBlocks.insert(it.key(), it.value());
+            continue;
+        }
+
+        Block &block = ownIt.value();
+        for (int y = 0; y < BlockSize; ++y)
+            block.rows[y] ^= it.value().rows[y];
+
+        if (block.isEmpty())
+            mBlocks.erase(ownIt);
+    }
+    return *this;
+}
+
+bool TileRegion::operator==(const TileRegion &other) const
+{
+    if (mBlocks.size() != other.mBlocks.size())
+        return false;
+
+    for (auto it = mBlocks.begin(), end = mBlocks.end(); it != end; ++it) {
+        auto otherIt = other.mBlocks.find(it.key());
+        if (otherIt == other.mBlocks.end())
+            return false;
+        if (std::memcmp(it.value().rows, otherIt.value().rows, sizeof(Block::rows)) != 0)
+            return false;
+    }
+
+    return true;
+}
+
+/**
+ * Returns the rectangles making up this region, in the same banded form
+ * as used by QRegion: sorted by top and then left, where rectangles with
+ * the same top have the same height and no two rectangles touch
+ * horizontally.
+ */
+QVector<QRect> TileRegion::rects() const
+{
+    QVector<QPair<QPoint, const Block*>> blocks;
+    blocks.reserve(mBlocks.size());
+    for (auto it = mBlocks.begin(), end = mBlocks.end(); it != end; ++it)
+        blocks.append(qMakePair(it.key(), &it.value()));
+
+    std::sort(blocks.begin(), blocks.end(), [] (const QPair<QPoint, const Block*> &a,
+                                                const QPair<QPoint, const Block*> &b) {
+        return a.first.y() < b.first.y() || (a.first.y() == b.first.y() && a.first.x() < b.first.x());
+    });
+
+    QVector<QRect> rects;
+
+    // Horizontal runs of the current row and of the band being collected
+    QVector<QPair<int, int>> runs;
+    QVector<QPair<int, int>> bandRuns;
+    int bandTop = 0;
+    int bandHeight = 0;
+
+    auto flushBand = [&] {
+        for (const auto &run : qAsConst(bandRuns))
+            rects.append(QRect(run.first, bandTop, run.second - run.first + 1, bandHeight));
+        bandRuns.clear();
+        bandHeight = 0;
+    };
+
+    for (int i = 0; i < blocks.size();) {
+        // Find the blocks in this row of blocks
+        int rowEnd = i + 1;
+        while (rowEnd < blocks.size() && blocks.at(rowEnd).first.y() == blocks.at(i).first.y())
+            ++rowEnd;
+
+        const int blockTop = blocks.at(i).first.y() * BlockSize;
+
+        for (int y = 0; y < BlockSize; ++y) {
+            runs.clear();
+
+            for (int b = i; b < rowEnd; ++b) {
+                const int blockLeft = blocks.at(b).first.x() * BlockSize;
+                quint64 bits = blocks.at(b).second->rows[y];
+
+                while (bits) {
+                    const int start = qCountTrailingZeroBits(bits);
+                    const quint64 remaining = ~(bits >> start);
+                    const int length = remaining ? qCountTrailingZeroBits(remaining) : BlockSize;
+                    const int left = blockLeft + start;
+                    const int right = left + length - 1;
+
+                    if (!runs.isEmpty() && runs.last().second + 1 == left)
+                        runs.last().second = right;
+                    else
+                        runs.append(qMakePair(left, right));
+
+                    bits &= ~bitRange(start, start + length - 1);
+                }
+            }
+
+            const int rowY = blockTop + y;
+            if (runs == bandRuns && bandHeight > 0 && bandTop + bandHeight == rowY) {
+                ++bandHeight;
+                continue;
+            }
+
+            flushBand();
+
+            if (!runs.isEmpty()) {
+                bandRuns.swap(runs);
+                bandTop = rowY;
+                bandHeight = 1;
+            }
+        }
+
+        i = rowEnd;
+    }
+
+    flushBand();
+
+    return rects;
+}
+
+QRegion TileRegion::toRegion() const
+{
+    const QVector<QRect> rects = this->rects();
+
+    QRegion region;
+    region.setRects(rects.constData(), rects.size());
+    return region;
+}
+
+} // namespace Tiled
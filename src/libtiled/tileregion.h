@@ -0,0 +1,125 @@
+/*
+ * tileregion.h
+ * Copyright 2026, agent <agent@local>
+ *
+ * This file is part of libtiled.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *    1. Redistributions of source code must retain the above copyright notice,
+ *       this list of conditions and the following disclaimer.
+ *
+ *    2. Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE CONTRIBUTORS ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO
+ * EVENT SHALL THE CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+ * ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#pragma once
+
+#include "pointhash.h"
+#include "tiled_global.h"
+
+#include <QHash>
+#include <QPoint>
+#include <QRect>
+#include <QRegion>
+#include <QVector>
+
+namespace Tiled {
+
+/**
+ * A set of tile positions, stored as a bit mask for each block of 64x64
+ * tiles.
+ *
+ * Unlike with QRegion, the cost of the boolean operations depends only on
+ * the covered area and not on how ragged the shape is, which makes this
+ * class suitable for selections and fill regions consisting of many small
+ * pieces. Use toRegion() where a QRegion is needed, like for display.
+ */
+class TILEDSHARED_EXPORT TileRegion
+{
+public:
+    static constexpr int BlockBits = 6;
+    static constexpr int BlockSize = 1 << BlockBits;
+    static constexpr int BlockMask = BlockSize - 1;
+
+    TileRegion() = default;
+    TileRegion(const QRect &rect);
+    TileRegion(const QRegion &region);
+
+    bool isEmpty() const { return mBlocks.isEmpty(); }
+    void clear() { mBlocks.clear(); }
+
+    bool contains(int x, int y) const;
+    bool contains(QPoint pos) const { return contains(pos.x(), pos.y()); }
+    bool intersects(const TileRegion &other) const;
+
+    QRect boundingRect() const;
+    int count() const;
+
+    void add(int x, int y);
+    void add(const QRect &rect);
+    void addRow(int x, int y, quint64 mask);
+
+    void translate(QPoint offset) { *this = translated(offset); }
+    TileRegion translated(QPoint offset) const;
+
+    TileRegion &operator|=(const TileRegion &other);
+    TileRegion &operator&=(const TileRegion &other);
+    TileRegion &operator-=(const TileRegion &other);
+    TileRegion &operator^=(const TileRegion &other);
+
+    TileRegion operator|(const TileRegion &other) const { return TileRegion(*this) |= other; }
+    TileRegion operator&(const TileRegion &other) const { return TileRegion(*this) &= other; }
+    TileRegion operator-(const TileRegion &other) const { return TileRegion(*this) -= other; }
+    TileRegion operator^(const TileRegion &other) const { return TileRegion(*this) ^= other; }
+
+    bool operator==(const TileRegion &other) const;
+    bool operator!=(const TileRegion &other) const { return !(*this == other); }
+
+    QVector<QRect> rects() const;
+    QRegion toRegion() const;
+
+private:
+    struct Block
+    {
+        bool isEmpty() const;
+
+        quint64 rows[BlockSize] = {};
+    };
+
+    quint64 &row(int x, int y) { return mBlocks[QPoint(x >> BlockBits, y >> BlockBits)].rows[y & BlockMask]; }
+
+    // Blocks are removed as soon as they become empty
+    QHash<QPoint, Block> mBlocks;
+};
+
+inline bool TileRegion::contains(int x, int y) const
+{
+    auto it = mBlocks.find(QPoint(x >> BlockBits, y >> BlockBits));
+    if (it == mBlocks.end())
+        return false;
+    return it.value().rows[y & BlockMask] & (quint64(1) << (x & BlockMask));
+}
+
+/**
+ * Adds the tile at the given position.
+ */
+inline void TileRegion::add(int x, int y)
+{
+    row(x, y) |= quint64(1) << (x & BlockMask);
+}
+
+} // namespace Tiled
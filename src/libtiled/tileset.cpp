@@ -275,6 +275,22 @@ bool Tileset::loadFromImage(const QString &fileName)
     return loadImage();
 }
 
+/**
+ * Returns the whole tileset image, with the transparent color masked out.
+ * The image of each tile is found at its Tile::imageRect().
+ *
+ * The image is created on demand by the ImageCache, so this function should
+ * only be called from the GUI thread. Returns a null pixmap for tilesets that
+ * were not loaded from an image file.
+ */
+QPixmap Tileset::image() const
+{
+    if (isCollection() || mImageReference.status != LoadingReady)
+        return QPixmap();
+
+    return ImageCache::loadTilesheet(tilesheetParameters());
+}
+
 /**
  * Tries to load the image this tileset is referring to.
  *
@@ -283,13 +299,7 @@ bool Tileset::loadFromImage(const QString &fileName)
  */
 bool Tileset::loadImage()
 {
-    TilesheetParameters p;
-    p.fileName = Tiled::urlToLocalFileOrQrc(mImageReference.source);
-    p.tileWidth = mTileWidth;
-    p.tileHeight = mTileHeight;
-    p.spacing = mTileSpacing;
-    p.margin = mMargin;
-    p.transparentColor = mImageReference.transparentColor;
+    const TilesheetParameters p = tilesheetParameters();
 
     if (p.tileWidth <= 0 || p.tileHeight <= 0) {
         mImageReference.status = LoadingError;
@@ -302,7 +312,8 @@ bool Tileset::loadImage()
         return false;
     }
 
-    auto tiles = ImageCache::cutTiles(p);
+    QVector<QRect> tileRects;
+    auto tiles = ImageCache::cutTiles(p, &tileRects);
 
     for (int tileNum = 0; tileNum < tiles.size(); ++tileNum) {
         auto it = mTilesById.find(tileNum);
@@ -310,9 +321,11 @@ bool Tileset::loadImage()
             it.value()->setImage(tiles.at(tileNum));
         } else {
             auto tile = new Tile(tiles.at(tileNum), tileNum, this);
-            mTilesById.insert(tileNum, tile);
+            it = mTilesById.insert(tileNum, tile);
             mTiles.insert(tileNum, tile);
         }
+
+        it.value()->setImageRect(tileRects.value(tileNum));
     }
 
     QPixmap blank;
@@ -690,6 +703,18 @@ SharedTileset Tileset::clone() const
     return c;
 }
 
+TilesheetParameters Tileset::tilesheetParameters() const
+{
+    TilesheetParameters p;
+    p.fileName = Tiled::urlToLocalFileOrQrc(mImageReference.source);
+    p.tileWidth = mTileWidth;
+    p.tileHeight = mTileHeight;
+    p.spacing = mTileSpacing;
+    p.margin = mMargin;
+    p.transparentColor = mImageReference.transparentColor;
+    return p;
+}
+
 /**
  * Sets tile size to the maximum size.
  */
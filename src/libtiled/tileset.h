@@ -50,6 +50,8 @@ class Tile;
 class Tileset;
 class WangSet;
 
+struct TilesheetParameters;
+
 using SharedTileset = QSharedPointer<Tileset>;
 
 /**
@@ -177,6 +179,8 @@ public:
     void setImageSource(const QString &url);
     QString imageSourceString() const;
 
+    QPixmap image() const;
+
     bool isCollection() const;
 
     int columnCountForWidth(int width) const;
@@ -254,6 +258,7 @@ public:
 
 private:
     void updateTileSize();
+    TilesheetParameters tilesheetParameters() const;
 
     QString mName;
     QString mFileName;
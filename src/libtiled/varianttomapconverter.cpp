@@ -947,9 +947,10 @@ bool VariantToMapConverter::readTileLayerData(TileLayer &tileLayer,
     case Map::Base64Zlib:
     case Map::Base64Gzip:
     case Map::Base64Zstandard:{
-        const QByteArray data = dataVariant.toByteArray();
+        const QString data = dataVariant.toString();
         GidMapper::DecodeError error = mGidMapper.decodeLayerData(tileLayer,
-                                                                  data,
+                                                                  data.constData(),
+                                                                  data.size(),
                                                                   layerDataFormat,
                                                                   bounds);
 
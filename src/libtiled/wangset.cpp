@@ -559,8 +559,10 @@ void WangSet::recalculateCells()
     const auto transformationFlags = tileset()->transformationFlags();
     mLastSeenTranslationFlags = transformationFlags;
 
-    if (!(transformationFlags & ~Tileset::PreferUntransformed))
+    if (!(transformationFlags & ~Tileset::PreferUntransformed)) {
+        recalculateMatchIndex();
         return;
+    }
 
     // Then insert variations based on flipping
     it.toFront();
@@ -612,6 +614,61 @@ void WangSet::recalculateCells()
             mWangIdAndCells.append({wangIds[i], cells[i]});
         }
     }
+
+    recalculateMatchIndex();
+}
+
+/**
+ * Indexes the colors of the WangIds in mWangIdAndCells, so that the ones
+ * matching a partial WangId can be found without looking at each of them.
+ */
+void WangSet::recalculateMatchIndex()
+{
+    int maximumColor = 0;
+    for (const WangIdAndCell &wangIdAndCell : qAsConst(mWangIdAndCells))
+        for (int i = 0; i < WangId::NumIndexes; ++i)
+            maximumColor = qMax(maximumColor, wangIdAndCell.wangId.indexColor(i));
+
+    mMatchIndexColors = maximumColor + 1;
+    mMatchIndexWords = (mWangIdAndCells.size() + 63) / 64;
+    mMatchIndex.fill(0, WangId::NumIndexes * mMatchIndexColors * mMatchIndexWords);
+
+    for (int n = 0; n < mWangIdAndCells.size(); ++n) {
+        const WangId wangId = mWangIdAndCells.at(n).wangId;
+        for (int i = 0; i < WangId::NumIndexes; ++i) {
+            const int offset = (i * mMatchIndexColors + wangId.indexColor(i)) * mMatchIndexWords;
+            mMatchIndex[offset + n / 64] |= quint64(1) << (n % 64);
+        }
+    }
+}
+
+/**
+ * Looks up the bit masks of the entries matching \a wangId at each index
+ * selected by \a mask.
+ *
+ * Returns the number of masks, or -1 when no entry can match. Returns -2
+ * when the mask selects only part of an index, which the index can't
+ * handle.
+ */
+int WangSet::matchMasks(WangId wangId, WangId mask, const quint64 *masks[]) const
+{
+    int count = 0;
+
+    for (int i = 0; i < WangId::NumIndexes; ++i) {
+        const int indexMask = mask.indexColor(i);
+        if (!indexMask)
+            continue;
+        if (indexMask != WangId::INDEX_MASK)
+            return -2;
+
+        const int color = wangId.indexColor(i);
+        if (color >= mMatchIndexColors)
+            return -1;
+
+        masks[count++] = mMatchIndex.constData() + (i * mMatchIndexColors + color) * mMatchIndexWords;
+    }
+
+    return count;
 }
 
 /**
@@ -851,15 +908,79 @@ bool WangSet::wangIdIsValid(WangId wangId, int colorCount)
  */
 bool WangSet::wangIdIsUsed(WangId wangId, WangId mask) const
 {
-    const quint64 maskedWangId = wangId & mask;
+    const auto &entries = wangIdsAndCells();
+
+    const quint64 *masks[WangId::NumIndexes];
+    const int count = matchMasks(wangId, mask, masks);
+
+    if (count == -1)
+        return false;
+
+    if (count == -2) {
+        const quint64 maskedWangId = wangId & mask;
 
-    for (const auto &wangIdAndCell : wangIdsAndCells())
-        if ((wangIdAndCell.wangId & mask) == maskedWangId)
+        for (const auto &wangIdAndCell : entries)
+            if ((wangIdAndCell.wangId & mask) == maskedWangId)
+                return true;
+
+        return false;
+    }
+
+    if (count == 0)
+        return !entries.isEmpty();
+
+    for (int word = 0; word < mMatchIndexWords; ++word) {
+        quint64 bits = masks[0][word];
+        for (int m = 1; m < count && bits; ++m)
+            bits &= masks[m][word];
+        if (bits)
             return true;
+    }
 
     return false;
 }
 
+/**
+ * Collects the positions in wangIdsAndCells() of the entries with a WangId
+ * matching the part of the \a wangId indicated by the \a mask.
+ *
+ * The colors at each index are indexed, so only the matching entries are
+ * looked at, as long as the mask selects whole indexes.
+ */
+void WangSet::findMatchingWangIds(WangId wangId, WangId mask, QVector<int> &matches) const
+{
+    matches.clear();
+
+    const auto &entries = wangIdsAndCells();
+
+    const quint64 *masks[WangId::NumIndexes];
+    const int count = matchMasks(wangId, mask, masks);
+
+    if (count == -1)
+        return;
+
+    if (count <= 0) {
+        const quint64 maskedWangId = wangId & mask;
+
+        for (int n = 0; n < entries.size(); ++n)
+            if ((entries.at(n).wangId & mask) == maskedWangId)
+                matches.append(n);
+
+        return;
+    }
+
+    for (int word = 0; word < mMatchIndexWords; ++word) {
+        quint64 bits = masks[0][word];
+        for (int m = 1; m < count && bits; ++m)
+            bits &= masks[m][word];
+
+        while (bits) {
+            matches.append(word * 64 + qCountTrailingZeroBits(bits));
+            bits &= bits - 1;
+        }
+    }
+}
+
 int WangSet::transitionPenalty(int colorA, int colorB) const
 {
     if (mColorDistancesDirty)
@@ -970,6 +1091,9 @@ WangSet *WangSet::clone(Tileset *tileset) const
     c->mColors = mColors;
     c->mTileIdToWangId = mTileIdToWangId;
     c->mWangIdAndCells = mWangIdAndCells;
+    c->mMatchIndex = mMatchIndex;
+    c->mMatchIndexColors = mMatchIndexColors;
+    c->mMatchIndexWords = mMatchIndexWords;
     c->mMaximumColorDistance = mMaximumColorDistance;
     c->mColorDistancesDirty = mColorDistancesDirty;
     c->mCellsDirty = mCellsDirty;
@@ -291,6 +291,8 @@ public:
 
     bool wangIdIsUsed(WangId wangId, WangId mask = WangId::FULL_MASK) const;
 
+    void findMatchingWangIds(WangId wangId, WangId mask, QVector<int> &matches) const;
+
     int transitionPenalty(int colorA, int colorB) const;
     int maximumColorDistance() const;
 
@@ -307,8 +309,11 @@ private:
 
     bool cellsDirty() const;
     void recalculateCells();
+    void recalculateMatchIndex();
     void recalculateColorDistances();
 
+    int matchMasks(WangId wangId, WangId mask, const quint64 *masks[]) const;
+
     Tileset *mTileset;
     QString mName;
     Type mType;
@@ -323,6 +328,12 @@ private:
 
     QVector<WangIdAndCell> mWangIdAndCells;
 
+    // For each index and color, a bit mask marking the entries in
+    // mWangIdAndCells that have that color at that index
+    QVector<quint64> mMatchIndex;
+    int mMatchIndexColors = 0;
+    int mMatchIndexWords = 0;
+
     int mMaximumColorDistance = 0;
     bool mColorDistancesDirty = true;
     bool mCellsDirty = true;
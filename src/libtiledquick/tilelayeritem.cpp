@@ -155,8 +155,7 @@ QSGNode *TileLayerItem::updatePaintNode(QSGNode *node,
      * drawn tiles are using the same tileset, they will share a single
      * geometry node.
      */
-    auto tileRenderFunction = [&](QPoint tilePos, const QPointF &screenPos) {
-        const Cell &cell = mLayer->cellAt(tilePos);
+    auto renderTile = [&](const Cell &cell, const QPointF &screenPos) {
         Tileset *tileset = cell.tileset();
         if (!tileset)
             return;
@@ -193,7 +192,13 @@ QSGNode *TileLayerItem::updatePaintNode(QSGNode *node,
         tileData.append(data);
     };
 
-    mRenderer->drawTileLayer(tileRenderFunction, mVisibleArea);
+    auto renderSpan = [&](const MapRenderer::TileSpan &span) {
+        mLayer->forEachCell(span.startTile, span.tileStep, span.count, [&](int index, const Cell &cell) {
+            renderTile(cell, span.screenPos(index));
+        });
+    };
+
+    mRenderer->drawTileSpans(renderSpan, mVisibleArea);
 
     if (!tileData.isEmpty())
         node->appendChildNode(new TilesNode(helper.texture(), tileData));
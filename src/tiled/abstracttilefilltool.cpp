@@ -246,7 +246,7 @@ void AbstractTileFillTool::updateRandomListAndMissingTilesets()
             mapDocument()->unifyTilesets(*variation.map, mMissingTilesets);
             if (mFillMethod == RandomFill) {
                 for (auto layer : variation.map->tileLayers()) {
-                    for (const Cell &cell : *static_cast<TileLayer*>(layer)) {
+                    for (const Cell &cell : *static_cast<const TileLayer*>(layer)) {
                         if (const Tile *tile = cell.tile())
                             mRandomCellPicker.add(cell, tile->probability());
                     }
@@ -286,6 +286,7 @@ void AbstractTileFillTool::wangFill(TileLayer &tileLayerToFill,
         return;
 
     WangFiller wangFiller(*mWangSet, mapDocument()->renderer());
+    wangFiller.setParallelEnabled(true);
 
     wangFiller.fillRegion(tileLayerToFill, backgroundTileLayer, region);
 }
@@ -23,6 +23,7 @@
 #include "brushitem.h"
 #include "changeselectedarea.h"
 #include "mapdocument.h"
+#include "tileregion.h"
 
 #include <QAction>
 #include <QActionGroup>
@@ -90,13 +91,16 @@ void AbstractTileSelectionTool::mousePressed(QGraphicsSceneMouseEvent *event)
 
         // Left button modifies selection, right button clears selection
         if (button == Qt::LeftButton) {
-            selection = document->selectedArea();
+            // Combining ragged regions is much faster on a TileRegion
+            TileRegion combined;
+            if (mSelectionMode != Replace)
+                combined = document->selectedArea();
 
             switch (mSelectionMode) {
             case Replace:   selection = mSelectedRegion; break;
-            case Add:       selection += mSelectedRegion; break;
-            case Subtract:  selection -= mSelectedRegion; break;
-            case Intersect: selection &= mSelectedRegion; break;
+            case Add:       selection = (combined |= mSelectedRegion).toRegion(); break;
+            case Subtract:  selection = (combined -= mSelectedRegion).toRegion(); break;
+            case Intersect: selection = (combined &= mSelectedRegion).toRegion(); break;
             }
         }
 
@@ -38,6 +38,7 @@
 #include "tilelayer.h"
 
 #include <QDebug>
+#include <QtConcurrent/QtConcurrentMap>
 #if QT_VERSION >= QT_VERSION_CHECK(5, 10, 0)
 #include <QRandomGenerator>
 #endif
@@ -51,6 +52,59 @@ static int wrap(int value, int bound)
     return (value % bound + bound) % bound;
 }
 
+namespace {
+
+/**
+ * Collects the region covered by the input of a rule at the offsets where it
+ * got applied. Consecutive offsets on the same row are merged, to avoid
+ * uniting a rectangle into the region for each application.
+ */
+class AppliedRegion
+{
+public:
+    AppliedRegion() = default;
+    explicit AppliedRegion(const QRect &inputBounds)
+        : mInputBounds(inputBounds)
+    {}
+
+    void add(QPoint offset)
+    {
+        if (mRunLength > 0 && offset.y() == mRunStart.y() &&
+                offset.x() == mRunStart.x() + mRunLength) {
+            ++mRunLength;
+            return;
+        }
+
+        flush();
+        mRunStart = offset;
+        mRunLength = 1;
+    }
+
+    QRegion region()
+    {
+        flush();
+        return mRegion;
+    }
+
+private:
+    void flush()
+    {
+        if (mRunLength > 0) {
+            mRegion += QRect(mRunStart + mInputBounds.topLeft(),
+                             QSize(mInputBounds.width() + mRunLength - 1,
+                                   mInputBounds.height()));
+            mRunLength = 0;
+        }
+    }
+
+    QRect mInputBounds;
+    QPoint mRunStart;
+    int mRunLength = 0;
+    QRegion mRegion;
+};
+
+} // anonymous namespace
+
 /*
  * About the order of the methods in this file.
  * The AutoMapper class has 3 bigger public functions, that is
@@ -381,9 +435,141 @@ bool AutoMapper::setupRuleList()
     }
 #endif
 
+    mSetLayerNames = mInputLayers.names.values();
+    std::sort(mSetLayerNames.begin(), mSetLayerNames.end());
+
+    for (RuleRegion &ruleRegion : mRuleRegions)
+        compileRule(ruleRegion);
+
     return true;
 }
 
+/**
+ * Fills \a cells with the list of all cells which can be found within all
+ * tile layers within the given region.
+ */
+static void collectCellsInRegion(const QVector<InputLayer> &list,
+                                 const QRegion &r,
+                                 QVector<Cell> &cells)
+{
+    for (const InputLayer &inputLayer : list) {
+#if QT_VERSION < 0x050800
+        const auto rects = r.rects();
+        for (const QRect &rect : rects) {
+#else
+        for (const QRect &rect : r) {
+#endif
+            for (int x = rect.left(); x <= rect.right(); ++x) {
+                for (int y = rect.top(); y <= rect.bottom(); ++y) {
+                    const Cell &cell = inputLayer.tileLayer->cellAt(x, y);
+                    if (!cells.contains(cell))
+                        cells.append(cell);
+                }
+            }
+        }
+    }
+}
+
+static bool containsEmptyCell(const QVector<Cell> &cells)
+{
+    return std::any_of(cells.begin(), cells.end(),
+                       [] (const Cell &cell) { return cell.isEmpty(); });
+}
+
+/**
+ * Finds a position in \a region where the yes list of the given
+ * \a conditions restricts the set cell to the returned \a cells. Positions
+ * where this doesn't include the empty cell are preferred.
+ *
+ * @return whether such a position was found
+ */
+static bool findAnchor(const InputConditions &conditions, const QRegion &region,
+                       QPoint &pos, QVector<Cell> &cells)
+{
+    bool found = false;
+
+#if QT_VERSION < 0x050800
+    const auto rects = region.rects();
+    for (const QRect &rect : rects) {
+#else
+    for (const QRect &rect : region) {
+#endif
+        for (int y = rect.top(); y <= rect.bottom(); ++y) {
+            for (int x = rect.left(); x <= rect.right(); ++x) {
+                QVector<Cell> candidates;
+                for (const InputLayer &inputLayer : conditions.listYes) {
+                    const Cell &cell = inputLayer.tileLayer->cellAt(x, y);
+                    if ((inputLayer.strictEmpty || !cell.isEmpty()) && !candidates.contains(cell))
+                        candidates.append(cell);
+                }
+
+                if (candidates.isEmpty())
+                    continue;
+
+                const bool matchesEmpty = containsEmptyCell(candidates);
+                if (!found || !matchesEmpty) {
+                    pos = QPoint(x, y);
+                    cells = candidates;
+                    found = true;
+
+                    if (!matchesEmpty)
+                        return true;
+                }
+            }
+        }
+    }
+
+    return found;
+}
+
+/**
+ * Precomputes the information needed to quickly match the given rule.
+ *
+ * For each input index, the cells used by the input layers are collected
+ * once, and an anchor is chosen: a position in the rule where the set layer
+ * must contain one of only a few specific cells. Most positions in the map
+ * can then be rejected by looking at a single cell.
+ */
+void AutoMapper::compileRule(RuleRegion &ruleRegion) const
+{
+    const QRegion &region = ruleRegion.input;
+
+    for (const InputIndex &inputIndex : mInputLayers) {
+        RuleInputIndex ruleInput;
+        bool anchorMatchesEmpty = true;
+
+        for (auto it = inputIndex.begin(), end = inputIndex.end(); it != end; ++it) {
+            const InputConditions &conditions = it.value();
+            const int setLayer = mSetLayerNames.indexOf(it.key());
+
+            RuleInputLayer inputLayer { setLayer, &conditions, {} };
+            if (conditions.listNo.isEmpty())
+                collectCellsInRegion(conditions.listYes, region, inputLayer.usedCells);
+            ruleInput.layers.append(inputLayer);
+
+            // Look for the best anchor, preferring one that can't match an
+            // empty cell since those are very common.
+            if (!anchorMatchesEmpty || conditions.listYes.isEmpty())
+                continue;
+
+            QPoint pos;
+            QVector<Cell> cells;
+            if (!findAnchor(conditions, region, pos, cells))
+                continue;
+
+            const bool matchesEmpty = containsEmptyCell(cells);
+            if (ruleInput.anchorSetLayer == -1 || !matchesEmpty) {
+                ruleInput.anchorSetLayer = setLayer;
+                ruleInput.anchorPos = pos;
+                ruleInput.anchorCells = cells;
+                anchorMatchesEmpty = matchesEmpty;
+            }
+        }
+
+        ruleRegion.inputIndexes.append(ruleInput);
+    }
+}
+
 void AutoMapper::prepareAutoMap()
 {
     setupWorkMapLayers();
@@ -441,6 +627,10 @@ void AutoMapper::setupWorkMapLayers()
     // need to be created if not present.
     for (const QString &name : qAsConst(mInputLayers.names))
         mSetLayers.insert(name, static_cast<TileLayer*>(mTargetMap->findLayer(name, Layer::TileLayerType)));
+
+    mSetLayerList.clear();
+    for (const QString &name : qAsConst(mSetLayerNames))
+        mSetLayerList.append(mSetLayers.value(name));
 }
 
 /**
@@ -463,21 +653,8 @@ void AutoMapper::autoMap(QRegion *where)
         return;
 
     // first resize the active area
-    if (mOptions.autoMappingRadius) {
-        QRegion region;
-#if QT_VERSION < 0x050800
-        const auto rects = where->rects();
-        for (const QRect &r : rects) {
-#else
-        for (const QRect &r : *where) {
-#endif
-            region += r.adjusted(- mOptions.autoMappingRadius,
-                                 - mOptions.autoMappingRadius,
-                                 + mOptions.autoMappingRadius,
-                                 + mOptions.autoMappingRadius);
-        }
-        where->swap(region);
-    }
+    if (mOptions.autoMappingRadius)
+        *where = extendedRegion(*where);
 
     // Delete all the relevant area, if the property "DeleteTiles" is set
     if (mOptions.deleteTiles) {
@@ -512,20 +689,86 @@ void AutoMapper::autoMap(QRegion *where)
     // This needs to be done, so you can rely on the order of the rules at all
     // locations
     QRegion ret;
+
+    if (!outputAffectsInput()) {
+        // The rules can all be matched against the current state of the map
+        ret = applyRulesInParallel(*where);
+    } else {
+        for (const RuleRegion &ruleRegion : qAsConst(mRuleRegions))
+            ret |= applyRule(ruleRegion, *where);
+    }
+
+    *where = where->united(ret);
+}
+
+/**
+ * Returns the given \a region extended by the AutomappingRadius.
+ */
+QRegion AutoMapper::extendedRegion(const QRegion &region) const
+{
+    const int radius = mOptions.autoMappingRadius;
+    if (!radius)
+        return region;
+
+    QRegion extended;
 #if QT_VERSION < 0x050800
-    const auto rects = where->rects();
-    for (const QRect &rect : rects) {
+    const auto rects = region.rects();
+    for (const QRect &r : rects)
+#else
+    for (const QRect &r : region)
+#endif
+        extended += r.adjusted(-radius, -radius, radius, radius);
+    return extended;
+}
+
+QRegion AutoMapper::touchedRegion(const QRegion &where) const
+{
+    // With WrapBorder, the output of a rule can wrap around the map
+    if (mOptions.wrapBorder)
+        return QRect(0, 0, mTargetMap->width(), mTargetMap->height());
+
+    const QRegion region = extendedRegion(where);
+
+    QRegion touched;
+    if (mOptions.deleteTiles)
+        touched = region;
+
+    for (const RuleRegion &ruleRegion : mRuleRegions) {
+        if (ruleRegion.output.isEmpty())
+            continue;
+
+        const QRect outputBounds = ruleRegion.output.boundingRect();
+        const QRegion offsets = ruleOffsets(ruleRegion, region);
+
+#if QT_VERSION < 0x050800
+        const auto rects = offsets.rects();
+        for (const QRect &rect : rects) {
 #else
-    for (const QRect &rect : *where) {
+        for (const QRect &rect : offsets) {
 #endif
-        for (const RuleRegion &ruleRegion : mRuleRegions) {
-            // at the moment the parallel execution does not work yet
-            // TODO: make multithreading available!
-            // either by dividing the rules or the region to multiple threads
-            ret |= applyRule(ruleRegion, rect);
+            touched += QRect(rect.topLeft() + outputBounds.topLeft(),
+                             rect.bottomRight() + outputBounds.bottomRight());
         }
     }
-    *where = where->united(ret);
+
+    if (!mTargetMap->infinite())
+        touched &= QRect(0, 0, mTargetMap->width(), mTargetMap->height());
+
+    return touched;
+}
+
+/**
+ * Returns whether any of the tile layers written by the rules is also used
+ * as input layer, in which case the rules need to be matched and applied one
+ * after another.
+ */
+bool AutoMapper::outputAffectsInput() const
+{
+    for (auto it = mTouchedTileLayers.begin(), end = mTouchedTileLayers.end(); it != end; ++it)
+        if (mInputLayers.names.contains(it.key()))
+            return true;
+
+    return false;
 }
 
 QRegion AutoMapper::computeSetLayersRegion() const
@@ -539,29 +782,28 @@ QRegion AutoMapper::computeSetLayersRegion() const
 }
 
 /**
- * Fills \a cells with the list of all cells which can be found within all
- * tile layers within the given region.
+ * Looks up the \a cell of the \a setLayer at the given position, taking into
+ * account the border options. Returns false when rules may not match at this
+ * position.
  */
-static void collectCellsInRegion(const QVector<InputLayer> &list,
-                                 const QRegion &r,
-                                 QVarLengthArray<Cell, 8> &cells)
+static bool setCellAt(const TileLayer &setLayer, int xd, int yd,
+                      const AutoMapper::Options &options, Cell &cell)
 {
-    for (const InputLayer &inputLayer : list) {
-#if QT_VERSION < 0x050800
-        const auto rects = r.rects();
-        for (const QRect &rect : rects) {
-#else
-        for (const QRect &rect : r) {
-#endif
-            for (int x = rect.left(); x <= rect.right(); ++x) {
-                for (int y = rect.top(); y <= rect.bottom(); ++y) {
-                    const Cell &cell = inputLayer.tileLayer->cellAt(x, y);
-                    if (!cells.contains(cell))
-                        cells.append(cell);
-                }
-            }
-        }
+    if (!options.matchOutsideMap && !setLayer.contains(xd, yd))
+        return false;
+
+    // Those two options are guaranteed to be false if the map is infinite,
+    // so no "invalid" width/height accessing here.
+    if (options.wrapBorder) {
+        xd = wrap(xd, setLayer.width());
+        yd = wrap(yd, setLayer.height());
+    } else if (options.overflowBorder) {
+        xd = qBound(0, xd, setLayer.width() - 1);
+        yd = qBound(0, yd, setLayer.height() - 1);
     }
+
+    cell = setLayer.cellAt(xd, yd);
+    return true;
 }
 
 /**
@@ -630,6 +872,7 @@ static void collectCellsInRegion(const QVector<InputLayer> &list,
  */
 static bool layerMatchesConditions(const TileLayer &setLayer,
                                    const InputConditions &conditions,
+                                   const QVector<Cell> &cells,
                                    const QRegion &ruleRegion,
                                    const QPoint offset,
                                    const AutoMapper::Options &options)
@@ -639,10 +882,6 @@ static bool layerMatchesConditions(const TileLayer &setLayer,
     if (listYes.isEmpty() && listNo.isEmpty())
         return false;
 
-    QVarLengthArray<Cell, 8> cells;
-    if (listNo.isEmpty())
-        collectCellsInRegion(listYes, ruleRegion, cells);
-
 #if QT_VERSION < 0x050800
     const auto rects = ruleRegion.rects();
     for (const QRect &rect : rects) {
@@ -651,24 +890,10 @@ static bool layerMatchesConditions(const TileLayer &setLayer,
 #endif
         for (int x = rect.left(); x <= rect.right(); ++x) {
             for (int y = rect.top(); y <= rect.bottom(); ++y) {
-                int xd = x + offset.x();
-                int yd = y + offset.y();
-
-                if (!options.matchOutsideMap && !setLayer.contains(xd, yd))
+                Cell setCell;
+                if (!setCellAt(setLayer, x + offset.x(), y + offset.y(), options, setCell))
                     return false;
 
-                // Those two options are guaranteed to be false if the map is infinite,
-                // so no "invalid" width/height accessing here.
-                if (options.wrapBorder) {
-                    xd = wrap(xd, setLayer.width());
-                    yd = wrap(yd, setLayer.height());
-                } else if (options.overflowBorder) {
-                    xd = qBound(0, xd, setLayer.width() - 1);
-                    yd = qBound(0, yd, setLayer.height() - 1);
-                }
-
-                const Cell &setCell = setLayer.cellAt(xd, yd);
-
                 // First check listNo. If any tile matches there, we can
                 // immediately know there is no match.
                 for (const InputLayer &inputNotLayer : listNo) {
@@ -709,128 +934,257 @@ static bool layerMatchesConditions(const TileLayer &setLayer,
     return true;
 }
 
-QRect AutoMapper::applyRule(const RuleRegion &ruleRegion, const QRect &where)
+/**
+ * Returns the offsets at which the input region of the rule given by
+ * \a ruleRegion overlaps the given \a where region. Only these positions
+ * need to be checked, since at any other position the rule doesn't touch
+ * \a where.
+ */
+QRegion AutoMapper::ruleOffsets(const RuleRegion &ruleRegion, const QRegion &where)
 {
-    Q_ASSERT(!mOutputLayerGroups.isEmpty());
+    QRegion offsets;
+
+    // Rules without input region are checked based on their (empty) bounds
+    const QRegion input = ruleRegion.input.isEmpty() ? QRegion(QRect(0, 0, 1, 1))
+                                                     : ruleRegion.input;
+
+#if QT_VERSION < 0x050800
+    const auto whereRects = where.rects();
+    const auto inputRects = input.rects();
+#else
+    const QRegion &whereRects = where;
+    const QRegion &inputRects = input;
+#endif
+
+    // There must be at least one tile overlap to the rule
+    for (const QRect &w : whereRects) {
+        for (const QRect &r : inputRects) {
+            offsets += QRect(QPoint(w.left() - r.right(), w.top() - r.bottom()),
+                             QPoint(w.right() - r.left(), w.bottom() - r.top()));
+        }
+    }
+
+    return offsets;
+}
+
+/**
+ * Returns whether the input of the rule given by \a ruleRegion matches the
+ * target map at the given \a offset. Only reads from the target map, so it
+ * can be called from multiple threads.
+ *
+ * The \a dummy layer is used for input layers that are missing in the
+ * target map.
+ */
+bool AutoMapper::ruleMatches(const RuleRegion &ruleRegion, QPoint offset,
+                             const TileLayer &dummy) const
+{
+    auto setLayer = [&] (int index) -> const TileLayer & {
+        const TileLayer *tileLayer = mSetLayerList.at(index);
+        return tileLayer ? *tileLayer : dummy;
+    };
+
+    for (const RuleInputIndex &ruleInput : ruleRegion.inputIndexes) {
+        // Quickly skip this input index when its anchor doesn't match
+        if (ruleInput.anchorSetLayer != -1) {
+            const QPoint pos = ruleInput.anchorPos + offset;
+            Cell setCell;
+            if (!setCellAt(setLayer(ruleInput.anchorSetLayer),
+                           pos.x(), pos.y(), mOptions, setCell) ||
+                    !ruleInput.anchorCells.contains(setCell))
+                continue;
+        }
+
+        bool allLayerNamesMatch = true;
+
+        for (const RuleInputLayer &inputLayer : ruleInput.layers) {
+            if (!layerMatchesConditions(setLayer(inputLayer.setLayer),
+                                        *inputLayer.conditions,
+                                        inputLayer.usedCells,
+                                        ruleRegion.input, offset, mOptions)) {
+                allLayerNamesMatch = false;
+                break;
+            }
+        }
+
+        if (allLayerNamesMatch)
+            return true;
+    }
 
-    QRect ret;
+    return false;
+}
 
-    const QRegion &ruleInputRegion = ruleRegion.input;
-    const QRegion &ruleOutputRegion = ruleRegion.output;
-    const QRect inputBounds = ruleInputRegion.boundingRect();
+QRegion AutoMapper::applyRule(const RuleRegion &ruleRegion, const QRegion &where)
+{
+    Q_ASSERT(!mOutputLayerGroups.isEmpty());
 
-    // Since the rule itself is translated, we need to adjust the borders of the
-    // loops. Decrease the size at all sides by one: There must be at least one
-    // tile overlap to the rule.
-    const int minX = where.left() - inputBounds.left() - inputBounds.width() + 1;
-    const int minY = where.top() - inputBounds.top() - inputBounds.height() + 1;
+    AppliedRegion ret(ruleRegion.input.boundingRect());
 
-    const int maxX = where.right() - inputBounds.left() + inputBounds.width() - 1;
-    const int maxY = where.bottom() - inputBounds.top() + inputBounds.height() - 1;
+    const QRegion offsets = ruleOffsets(ruleRegion, where);
 
     // These regions store which parts or the map have already been altered by
     // exactly this rule. We store all the altered parts to make sure there are
     // no overlaps of the same rule applied to (neighbouring) places.
-    QMap<const Layer*, QRegion> appliedRegions;
+    QMap<const Layer*, TileRegion> appliedRegions;
 
     const TileLayer dummy(QString(), 0, 0, mTargetMap->width(), mTargetMap->height());
 
-#if QT_VERSION >= QT_VERSION_CHECK(5, 10, 0)
-    QRandomGenerator *randomGenerator = QRandomGenerator::global();
+#if QT_VERSION < 0x050800
+    const auto rects = offsets.rects();
+    for (const QRect &rect : rects) {
+#else
+    for (const QRect &rect : offsets) {
 #endif
+        for (int y = rect.top(); y <= rect.bottom(); ++y)
+        for (int x = rect.left(); x <= rect.right(); ++x) {
+            if (ruleMatches(ruleRegion, QPoint(x, y), dummy) &&
+                    applyRuleOutput(ruleRegion, QPoint(x, y), appliedRegions)) {
+                ret.add(QPoint(x, y));
+            }
+        }
+    }
 
-    for (int y = minY; y <= maxY; ++y)
-    for (int x = minX; x <= maxX; ++x) {
-        bool anyMatch = false;
+    return ret.region();
+}
 
-        for (const InputIndex &inputIndex : qAsConst(mInputLayers)) {
-            bool allLayerNamesMatch = true;
+/**
+ * Finds the matches of all rules in parallel and then applies them in the
+ * same order as they would have been applied by applyRule().
+ *
+ * This is only valid when applying a rule can't affect the matching of the
+ * rules, which is the case when none of the output layers is also used as
+ * input layer.
+ *
+ * @return the region where rules actually got applied
+ */
+QRegion AutoMapper::applyRulesInParallel(const QRegion &where)
+{
+    Q_ASSERT(!mOutputLayerGroups.isEmpty());
 
-            QMapIterator<QString, InputConditions> inputIndexIterator(inputIndex);
-            while (inputIndexIterator.hasNext()) {
-                inputIndexIterator.next();
+    // The offsets to check for each rule are split into bands of rows, to
+    // make sure all threads have work even when there are only few rules.
+    static constexpr int BandHeight = 32;
 
-                const QString &name = inputIndexIterator.key();
-                const InputConditions &conditions = inputIndexIterator.value();
+    struct MatchJob
+    {
+        const RuleRegion *ruleRegion;
+        QRect offsets;
+        bool firstBand;
+        QVector<QPoint> matches;
+    };
 
-                const TileLayer &setLayer = *mSetLayers.value(name, &dummy);
+    QVector<MatchJob> jobs;
 
-                if (!layerMatchesConditions(setLayer, conditions, ruleInputRegion, QPoint(x, y), mOptions)) {
-                    allLayerNamesMatch = false;
-                    break;
-                }
-            }
+    for (const RuleRegion &ruleRegion : qAsConst(mRuleRegions)) {
+        const QRegion offsets = ruleOffsets(ruleRegion, where);
+        bool firstBand = true;
 
-            if (allLayerNamesMatch) {
-                anyMatch = true;
-                break;
+#if QT_VERSION < 0x050800
+        const auto rects = offsets.rects();
+        for (const QRect &rect : rects) {
+#else
+        for (const QRect &rect : offsets) {
+#endif
+            for (int y = rect.top(); y <= rect.bottom(); y += BandHeight) {
+                const QRect band(QPoint(rect.left(), y),
+                                 QPoint(rect.right(), qMin(y + BandHeight - 1, rect.bottom())));
+                jobs.append(MatchJob { &ruleRegion, band, firstBand, {} });
+                firstBand = false;
             }
         }
+    }
+
+    const TileLayer dummy(QString(), 0, 0, mTargetMap->width(), mTargetMap->height());
+
+    QtConcurrent::blockingMap(jobs, [&] (MatchJob &job) {
+        for (int y = job.offsets.top(); y <= job.offsets.bottom(); ++y)
+            for (int x = job.offsets.left(); x <= job.offsets.right(); ++x)
+                if (ruleMatches(*job.ruleRegion, QPoint(x, y), dummy))
+                    job.matches.append(QPoint(x, y));
+    });
 
-        if (anyMatch) {
-            // choose by chance which group of rule_layers should be used:
+    QRegion ret;
+    AppliedRegion applied;
+    QMap<const Layer*, TileRegion> appliedRegions;
+
+    for (const MatchJob &job : qAsConst(jobs)) {
+        if (job.firstBand) {
+            ret |= applied.region();
+            applied = AppliedRegion(job.ruleRegion->input.boundingRect());
+            appliedRegions.clear();
+        }
+
+        for (const QPoint &offset : job.matches)
+            if (applyRuleOutput(*job.ruleRegion, offset, appliedRegions))
+                applied.add(offset);
+    }
+
+    return ret | applied.region();
+}
+
+/**
+ * Copies the output of the rule given by \a ruleRegion to the target map at
+ * the given \a offset, choosing one of the output layer groups by chance.
+ *
+ * When rules are not allowed to overlap, \a appliedRegions is used to skip
+ * outputs that would overlap earlier applications of the same rule.
+ *
+ * @return whether the output was applied
+ */
+bool AutoMapper::applyRuleOutput(const RuleRegion &ruleRegion, QPoint offset,
+                                 QMap<const Layer*, TileRegion> &appliedRegions)
+{
+    // choose by chance which group of rule_layers should be used:
 #if QT_VERSION >= QT_VERSION_CHECK(5, 10, 0)
-            const int r = randomGenerator->generate() % mOutputLayerGroups.size();
+    const int r = QRandomGenerator::global()->generate() % mOutputLayerGroups.size();
 #else
-            const int r = qrand() % mOutputLayerGroups.size();
+    const int r = qrand() % mOutputLayerGroups.size();
 #endif
-            const RuleOutput &ruleOutput = mOutputLayerGroups.at(r);
-
-            if (mOptions.noOverlappingRules) {
-                bool overlap = false;
-
-                // check if there are no overlaps within this rule.
-                QMap<const Layer*, QRegion> ruleRegionInLayer;
-
-                QMapIterator<const Layer*, QString> it(ruleOutput);
-                while (it.hasNext()) {
-                    const Layer *layer = it.next().key();
-
-                    QRegion outputLayerRegion;
-
-                    // TODO: Very slow to re-calculate the entire region for
-                    // each rule output layer here, each time a rule has a match.
-                    switch (layer->layerType()) {
-                    case Layer::TileLayerType:
-                        outputLayerRegion = static_cast<const TileLayer*>(layer)->region();
-                        break;
-                    case Layer::ObjectGroupType:
-                        outputLayerRegion = tileRegionOfObjectGroup(static_cast<const ObjectGroup*>(layer));
-                        break;
-                    case Layer::ImageLayerType:
-                    case Layer::GroupLayerType:
-                        Q_UNREACHABLE();
-                        continue;
-                    }
-
-                    outputLayerRegion &= ruleOutputRegion;
-                    outputLayerRegion.translate(x, y);
+    const RuleOutput &ruleOutput = mOutputLayerGroups.at(r);
 
-                    ruleRegionInLayer[layer] = outputLayerRegion;
+    if (mOptions.noOverlappingRules) {
+        // check if there are no overlaps within this rule.
+        QMap<const Layer*, TileRegion> ruleRegionInLayer;
 
-                    if (appliedRegions[layer].intersects(outputLayerRegion)) {
-                        overlap = true;
-                        break;
-                    }
-                }
+        QMapIterator<const Layer*, QString> it(ruleOutput);
+        while (it.hasNext()) {
+            const Layer *layer = it.next().key();
 
-                if (overlap)
-                    continue;
+            TileRegion outputLayerRegion;
 
-                // Remember the newly applied region
-                it.toFront();
-                while (it.hasNext()) {
-                    const Layer *layer = it.next().key();
-                    appliedRegions[layer] |= ruleRegionInLayer[layer];
-                }
+            // TODO: Very slow to re-calculate the entire region for
+            // each rule output layer here, each time a rule has a match.
+            switch (layer->layerType()) {
+            case Layer::TileLayerType:
+                outputLayerRegion = static_cast<const TileLayer*>(layer)->tileRegion();
+                break;
+            case Layer::ObjectGroupType:
+                outputLayerRegion = tileRegionOfObjectGroup(static_cast<const ObjectGroup*>(layer));
+                break;
+            case Layer::ImageLayerType:
+            case Layer::GroupLayerType:
+                Q_UNREACHABLE();
+                continue;
             }
 
-            copyMapRegion(ruleOutputRegion, QPoint(x, y), ruleOutput);
-            ret |= inputBounds.translated(QPoint(x, y));
+            outputLayerRegion &= ruleRegion.output;
+            outputLayerRegion.translate(offset);
+
+            ruleRegionInLayer[layer] = outputLayerRegion;
+
+            if (appliedRegions[layer].intersects(outputLayerRegion))
+                return false;
+        }
+
+        // Remember the newly applied region
+        it.toFront();
+        while (it.hasNext()) {
+            const Layer *layer = it.next().key();
+            appliedRegions[layer] |= ruleRegionInLayer[layer];
         }
     }
 
-    return ret;
+    copyMapRegion(ruleRegion.output, offset, ruleOutput);
+    return true;
 }
 
 void AutoMapper::copyMapRegion(const QRegion &region, QPoint offset,
@@ -20,6 +20,7 @@
 
 #pragma once
 
+#include "tilelayer.h"
 #include "tileset.h"
 
 #include <QList>
@@ -27,6 +28,7 @@
 #include <QRegion>
 #include <QSet>
 #include <QString>
+#include <QStringList>
 #include <QVector>
 
 #include <memory>
@@ -37,7 +39,6 @@ class Layer;
 class Map;
 class MapObject;
 class ObjectGroup;
-class TileLayer;
 
 class MapDocument;
 
@@ -167,6 +168,13 @@ public:
      */
     void autoMap(QRegion *where);
 
+    /**
+     * Returns the region of the touched tile layers that may be changed by
+     * calling autoMap() with the given \a where region. Only valid after
+     * prepareAutoMap() was called.
+     */
+    QRegion touchedRegion(const QRegion &where) const;
+
     /**
      * This cleans all data structures, which are setup via prepareAutoMap,
      * so the auto mapper becomes ready for its next automatic mapping.
@@ -184,10 +192,34 @@ public:
     QString warningString() const { return mWarning; }
 
 private:
+    struct RuleInputLayer
+    {
+        int setLayer;                       // index in mSetLayerList
+        const InputConditions *conditions;
+        QVector<Cell> usedCells;            // cells used by the "input" layers
+    };
+
+    /**
+     * Precompiled information about matching one input index of a rule.
+     *
+     * The anchor is a position in the rule at which the set layer must
+     * contain one of the anchor cells. It allows most positions to be
+     * rejected before checking all conditions.
+     */
+    struct RuleInputIndex
+    {
+        QVector<RuleInputLayer> layers;
+
+        int anchorSetLayer = -1;            // index in mSetLayerList
+        QPoint anchorPos;
+        QVector<Cell> anchorCells;
+    };
+
     struct RuleRegion
     {
         QRegion input;
         QRegion output;
+        QVector<RuleInputIndex> inputIndexes;
     };
 
     /**
@@ -202,6 +234,7 @@ private:
      * @return returns true when anything is ok, false when errors occurred.
      */
     bool setupRuleList();
+    void compileRule(RuleRegion &ruleRegion) const;
 
     /**
      * Sets up the layers in the rules map, which are used for automapping.
@@ -253,14 +286,24 @@ private:
                        const RuleOutput &layerTranslation);
 
     /**
-     * This goes through all the positions of the mTargetMap and checks if
-     * there fits the rule given by \a ruleRegion.
+     * This goes through all the positions of the mTargetMap at which the rule
+     * given by \a ruleRegion overlaps \a where and checks if the rule fits
+     * there.
      *
      * If there is a match all output layers are copied to mTargetMap.
      *
-     * @return a rectangle where the rule actually got applied
+     * @return the region where the rule actually got applied
      */
-    QRect applyRule(const RuleRegion &ruleRegion, const QRect &where);
+    QRegion applyRule(const RuleRegion &ruleRegion, const QRegion &where);
+    QRegion applyRulesInParallel(const QRegion &where);
+
+    static QRegion ruleOffsets(const RuleRegion &ruleRegion, const QRegion &where);
+    QRegion extendedRegion(const QRegion &region) const;
+    bool ruleMatches(const RuleRegion &ruleRegion, QPoint offset,
+                     const TileLayer &dummy) const;
+    bool applyRuleOutput(const RuleRegion &ruleRegion, QPoint offset,
+                         QMap<const Layer*, TileRegion> &appliedRegions);
+    bool outputAffectsInput() const;
 
     /**
      * Cleans up the data structures filled by setupTilesets(),
@@ -333,6 +376,12 @@ private:
      */
     InputLayers mInputLayers;
 
+    /**
+     * The sorted names of all input layers, used to refer to the "set"
+     * layers by index.
+     */
+    QStringList mSetLayerNames;
+
     /**
      * Stores the input and output region for each rule in mRulesMap.
      */
@@ -359,6 +408,7 @@ private:
      * @see setupWorkMapLayers()
      */
     QMap<QString, const TileLayer*> mSetLayers;
+    QVector<const TileLayer*> mSetLayerList;    // in the order of mSetLayerNames
     QMap<QString, TileLayer*> mTouchedTileLayers;
     QMap<QString, ObjectGroup*> mTouchedObjectGroups;
 
@@ -30,26 +30,66 @@
 
 using namespace Tiled;
 
+/**
+ * Returns the part of \a region where the cells of \a a and \a b differ.
+ */
+static QRegion diffRegion(const TileLayer &a, const TileLayer &b, const QRegion &region)
+{
+    QRegion ret;
+
+#if QT_VERSION < 0x050800
+    const auto rects = region.rects();
+    for (const QRect &r : rects) {
+#else
+    for (const QRect &r : region) {
+#endif
+        for (int y = r.top(); y <= r.bottom(); ++y) {
+            for (int x = r.left(); x <= r.right(); ++x) {
+                if (a.cellAt(x, y) != b.cellAt(x, y)) {
+                    const int rangeStart = x;
+                    while (x <= r.right() && a.cellAt(x, y) != b.cellAt(x, y))
+                        ++x;
+                    ret += QRect(rangeStart, y, x - rangeStart, 1);
+                }
+            }
+        }
+    }
+
+    return ret;
+}
+
 AutoMapperWrapper::AutoMapperWrapper(MapDocument *mapDocument,
                                      const QVector<AutoMapper*> &autoMappers,
                                      QRegion *where)
     : mMapDocument(mapDocument)
 {
-    for (AutoMapper *autoMapper : autoMappers) {
+    for (AutoMapper *autoMapper : autoMappers)
         autoMapper->prepareAutoMap();
 
-        // Store a copy of each touched tile layer before AutoMapping.
-        for (TileLayer *layer : autoMapper->touchedTileLayers()) {
-            if (mTouchedTileLayers.find(layer) != mTouchedTileLayers.end())
-                continue;
+    for (AutoMapper *autoMapper : autoMappers) {
+        // Store a copy of the part of each touched tile layer that may be
+        // changed by this AutoMapper. Since the region only grows as more
+        // AutoMappers are applied, parts that were stored before still hold
+        // the original cells.
+        const QRegion touched = autoMapper->touchedRegion(*where);
 
+        for (TileLayer *layer : autoMapper->touchedTileLayers()) {
             TouchedLayerData &data = mTouchedTileLayers[layer];
-            data.before.reset(layer->clone());
+            if (!data.before) {
+                data.before = std::make_unique<TileLayer>(layer->name(),
+                                                          layer->x(), layer->y(),
+                                                          layer->width(), layer->height());
+                data.drawMargins = layer->drawMargins();
+                data.bounds = layer->bounds();
+            }
+
+            const QRegion newRegion = touched.subtracted(data.region);
+            data.before->setCells(0, 0, layer, newRegion);
+            data.region |= newRegion;
         }
-    }
 
-    for (AutoMapper *autoMapper : autoMappers)
         autoMapper->autoMap(where);
+    }
 
     for (std::pair<TileLayer* const, TouchedLayerData> &pair : mTouchedTileLayers) {
         auto target = pair.first;
@@ -57,16 +97,16 @@ AutoMapperWrapper::AutoMapperWrapper(MapDocument *mapDocument,
 
         MapDocument::TileLayerChangeFlags flags;
 
-        if (before->drawMargins() != target->drawMargins())
+        if (pair.second.drawMargins != target->drawMargins())
             flags |= MapDocument::LayerDrawMarginsChanged;
-        if (before->bounds() != target->bounds())
+        if (pair.second.bounds != target->bounds())
             flags |= MapDocument::LayerBoundsChanged;
 
         if (flags)
             emit mMapDocument->tileLayerChanged(target, flags);
 
         // reduce memory usage by saving only diffs
-        pair.second.region = before->computeDiffRegion(target);
+        pair.second.region = diffRegion(*before, *target, pair.second.region);
         const QRect diffRect = pair.second.region.boundingRect();
 
         auto beforeDiff = before->copy(pair.second.region);
@@ -37,9 +37,9 @@ class MapDocument;
  * This is a wrapper class for applying one or more AutoMapper instances,
  * providing undo/redo functionality.
  *
- * This class will take a snapshot of the layers before and after the
- * automapping is done. In between the instances of AutoMapper are doing the
- * work.
+ * This class will take a snapshot of the parts of the layers that may be
+ * touched before and after the automapping is done. In between the instances
+ * of AutoMapper are doing the work.
  */
 class AutoMapperWrapper : public QUndoCommand
 {
@@ -60,6 +60,8 @@ private:
         QRegion region;
         std::unique_ptr<TileLayer> before;
         std::unique_ptr<TileLayer> after;
+        QMargins drawMargins;
+        QRect bounds;
     };
 
     MapDocument *mMapDocument;
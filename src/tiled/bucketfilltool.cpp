@@ -49,10 +49,19 @@ BucketFillTool::BucketFillTool(QObject *parent)
                            parent)
     , mLastFillMethod(mFillMethod)
 {
+    connect(&mFillRegionWatcher, &QFutureWatcher<QRegion>::finished,
+            this, &BucketFillTool::fillRegionComputed);
 }
 
 BucketFillTool::~BucketFillTool()
 {
+    cancelFillRegionComputation();
+}
+
+void BucketFillTool::deactivate(MapScene *scene)
+{
+    cancelFillRegionComputation();
+    AbstractTileFillTool::deactivate(scene);
 }
 
 void BucketFillTool::tilePositionChanged(QPoint tilePos)
@@ -86,6 +95,7 @@ void BucketFillTool::tilePositionChanged(QPoint tilePos)
 
         // Clear overlay to make way for a new one
         AbstractTileFillTool::clearOverlay();
+        cancelFillRegionComputation();
 
         // Cache information about how the fill region was created
         mLastShiftStatus = shiftPressed;
@@ -106,8 +116,25 @@ void BucketFillTool::tilePositionChanged(QPoint tilePos)
                 }
             }
 
-            if (computeRegion)
-                mFillRegion = regionComputer.computePaintableFillRegion(tilePos);
+            if (computeRegion) {
+                mFillRegion = QRegion();
+
+                for (const QRegion &region : qAsConst(mCachedFillRegions)) {
+                    if (region.contains(tilePos)) {
+                        mFillRegion = region;
+                        break;
+                    }
+                }
+
+                // Compute the region in the background, to keep the cursor
+                // responsive. The preview is shown once it is done.
+                if (mFillRegion.isEmpty()) {
+                    mFillRegionCanceled = std::make_shared<std::atomic_bool>(false);
+                    mFillRegionWatcher.setFuture(
+                                regionComputer.computePaintableFillRegionAsync(tilePos, mFillRegionCanceled));
+                    return;
+                }
+            }
         } else {
             // If holding shift, the region is the selection bounds
             mFillRegion = mapDocument()->selectedArea();
@@ -123,6 +150,11 @@ void BucketFillTool::tilePositionChanged(QPoint tilePos)
         fillRegionChanged = true;
     }
 
+    showFillPreview(fillRegionChanged);
+}
+
+void BucketFillTool::showFillPreview(bool fillRegionChanged)
+{
     // Ensure that a fill region was created before making an overlay layer
     if (mFillRegion.isEmpty())
         return;
@@ -151,6 +183,14 @@ void BucketFillTool::mousePressed(QGraphicsSceneMouseEvent *event)
 
     if (event->button() != Qt::LeftButton)
         return;
+
+    // Wait for the fill region that is still being computed, so that
+    // clicking right after moving the mouse isn't ignored
+    if (mFillRegionCanceled) {
+        mFillRegionWatcher.waitForFinished();
+        fillRegionComputed();
+    }
+
     if (mFillRegion.isEmpty())
         return;
     if (!brushItem()->isVisible())
@@ -183,6 +223,32 @@ void BucketFillTool::languageChanged()
     mStampActions->languageChanged();
 }
 
+void BucketFillTool::mapDocumentChanged(MapDocument *oldDocument,
+                                        MapDocument *newDocument)
+{
+    AbstractTileFillTool::mapDocumentChanged(oldDocument, newDocument);
+
+    if (oldDocument) {
+        disconnect(oldDocument, &MapDocument::regionChanged,
+                   this, &BucketFillTool::invalidateFillRegions);
+        disconnect(oldDocument, &MapDocument::currentLayerChanged,
+                   this, &BucketFillTool::invalidateFillRegions);
+        disconnect(oldDocument, &MapDocument::selectedAreaChanged,
+                   this, &BucketFillTool::invalidateFillRegions);
+    }
+
+    invalidateFillRegions();
+
+    if (newDocument) {
+        connect(newDocument, &MapDocument::regionChanged,
+                this, &BucketFillTool::invalidateFillRegions);
+        connect(newDocument, &MapDocument::currentLayerChanged,
+                this, &BucketFillTool::invalidateFillRegions);
+        connect(newDocument, &MapDocument::selectedAreaChanged,
+                this, &BucketFillTool::invalidateFillRegions);
+    }
+}
+
 void BucketFillTool::clearOverlay()
 {
     // Clear connections before clearing overlay so there is no
@@ -227,4 +293,40 @@ void BucketFillTool::clearConnections(MapDocument *mapDocument)
                this, &BucketFillTool::clearOverlay);
 }
 
+void BucketFillTool::fillRegionComputed()
+{
+    // Ignore the result when it was canceled in the meantime
+    if (!mFillRegionCanceled)
+        return;
+
+    mFillRegionCanceled.reset();
+
+    const QRegion fillRegion = mFillRegionWatcher.result();
+    if (fillRegion.isEmpty() || !currentTileLayer())
+        return;
+
+    mCachedFillRegions.prepend(fillRegion);
+    if (mCachedFillRegions.size() > 8)
+        mCachedFillRegions.removeLast();
+
+    clearConnections(mapDocument());
+
+    mFillRegion = fillRegion;
+    showFillPreview(true);
+}
+
+void BucketFillTool::cancelFillRegionComputation()
+{
+    if (mFillRegionCanceled) {
+        *mFillRegionCanceled = true;
+        mFillRegionCanceled.reset();
+    }
+}
+
+void BucketFillTool::invalidateFillRegions()
+{
+    mCachedFillRegions.clear();
+    cancelFillRegionComputation();
+}
+
 #include "moc_bucketfilltool.cpp"
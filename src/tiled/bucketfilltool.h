@@ -26,6 +26,11 @@
 #include "tilelayer.h"
 #include "tilestamp.h"
 
+#include <QFutureWatcher>
+
+#include <atomic>
+#include <memory>
+
 namespace Tiled {
 
 class WangSet;
@@ -45,6 +50,8 @@ public:
     BucketFillTool(QObject *parent = nullptr);
     ~BucketFillTool() override;
 
+    void deactivate(MapScene *scene) override;
+
     void mousePressed(QGraphicsSceneMouseEvent *event) override;
 
     void modifiersChanged(Qt::KeyboardModifiers) override;
@@ -52,11 +59,19 @@ public:
     void languageChanged() override;
 
 protected:
+    void mapDocumentChanged(MapDocument *oldDocument,
+                            MapDocument *newDocument) override;
+
     void tilePositionChanged(QPoint tilePos) override;
     void clearConnections(MapDocument *mapDocument) override;
 
 private:
     void clearOverlay();
+    void showFillPreview(bool fillRegionChanged);
+
+    void fillRegionComputed();
+    void cancelFillRegionComputation();
+    void invalidateFillRegions();
 
     Qt::KeyboardModifiers mModifiers;
     bool mLastShiftStatus;
@@ -71,6 +86,15 @@ private:
 
     QRegion mFillRegion;
 
+    /**
+     * Recently computed fill regions, which remain valid until the layer
+     * contents, the current layer or the selection change.
+     */
+    QVector<QRegion> mCachedFillRegions;
+
+    QFutureWatcher<QRegion> mFillRegionWatcher;
+    std::shared_ptr<std::atomic_bool> mFillRegionCanceled;
+
     void makeConnections();
 };
 
@@ -40,6 +40,7 @@
 #include <QFileInfo>
 #include <QJsonArray>
 #include <QJsonDocument>
+#include <QPixmapCache>
 #include <QtPlugin>
 
 #include "qtcompat_p.h"
@@ -503,6 +504,10 @@ int main(int argc, char *argv[])
     StyleHelper::initialize();
     Session::initialize();
 
+    // The map view caches pre-rendered parts of tile layers as pixmaps, of
+    // which the default limit only fits a few (in kilobytes)
+    QPixmapCache::setCacheLimit(Preferences::instance()->get<int>("Interface/PixmapCacheLimit", 256 * 1024));
+
     MainWindow w;
     w.show();
 
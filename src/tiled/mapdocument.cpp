@@ -1655,6 +1655,9 @@ void MapDocument::detachObjects(const QList<MapObject *> &objects)
 void MapDocument::createRenderer()
 {
     mRenderer = MapRenderer::create(mMap.get());
+
+    // Batches tiles per tileset when the map view uses OpenGL
+    mRenderer->setFlag(UseTilesetAtlas);
 }
 
 #include "moc_mapdocument.cpp"
@@ -21,6 +21,7 @@
 #include "abstractworldtool.h"
 #include "mapitem.h"
 
+#include "containerhelpers.h"
 #include "documentmanager.h"
 #include "grouplayer.h"
 #include "grouplayeritem.h"
@@ -37,6 +38,7 @@
 #include "tilelayer.h"
 #include "tilelayeritem.h"
 #include "tileselectionitem.h"
+#include "tilesetmanager.h"
 #include "zoomable.h"
 
 #include <QCursor>
@@ -168,6 +170,10 @@ MapItem::MapItem(const MapDocumentPtr &mapDocument, DisplayMode displayMode,
     connect(mapDocument.data(), &MapDocument::objectsInserted, this, &MapItem::objectsInserted);
     connect(mapDocument.data(), &MapDocument::objectsIndexChanged, this, &MapItem::objectsIndexChanged);
 
+    TilesetManager *tilesetManager = TilesetManager::instance();
+    connect(tilesetManager, &TilesetManager::tilesetImagesChanged, this, &MapItem::tilesetImagesChanged);
+    connect(tilesetManager, &TilesetManager::repaintTileset, this, &MapItem::tilesetImagesChanged);
+
     updateBoundingRect();
 
     mDarkRectangle->setPen(Qt::NoPen);
@@ -255,9 +261,7 @@ void MapItem::setShowTileCollisionShapes(bool enabled)
             if (tile->objectGroup() && !tile->objectGroup()->isEmpty())
                 item->syncWithMapObject();
 
-    for (LayerItem *item : qAsConst(mLayerItems))
-        if (item->layer()->isTileLayer())
-            item->update();
+    invalidateTileLayerCaches();
 }
 
 void MapItem::updateLayerPositions()
@@ -361,6 +365,7 @@ void MapItem::repaintRegion(const QRegion &region, TileLayer *tileLayer)
                             margins.right(),
                             margins.bottom());
 
+        tileLayerItem->invalidateCache(boundingRect);
         tileLayerItem->update(boundingRect);
     }
 }
@@ -508,6 +513,9 @@ void MapItem::layerTintColorChanged(Layer *layer)
 {
     switch (layer->layerType()) {
     case Layer::TileLayerType:
+        static_cast<TileLayerItem*>(mLayerItems.value(layer))->invalidateCache();
+        mLayerItems.value(layer)->update();
+        break;
     case Layer::ImageLayerType:
         mLayerItems.value(layer)->update();
         break;
@@ -571,6 +579,8 @@ void MapItem::tileObjectGroupChanged(Tile *tile)
     if (!Preferences::instance()->showTileCollisionShapes())
         return;
 
+    invalidateTileLayerCaches(tile->tileset());
+
     for (MapObjectItem *item : qAsConst(mObjectItems)) {
         const Cell &cell = item->mapObject()->cell();
         if (cell.tile() == tile)
@@ -584,6 +594,35 @@ void MapItem::tilesetReplaced(int index, Tileset *tileset)
     adaptToTilesetTileSizeChanges(tileset);
 }
 
+/**
+ * Called when the images of the given \a tileset have changed, which
+ * includes changes to the current frame of animated tiles.
+ */
+void MapItem::tilesetImagesChanged(Tileset *tileset)
+{
+    if (contains(mapDocument()->map()->tilesets(), tileset))
+        invalidateTileLayerCaches(tileset);
+}
+
+/**
+ * Drops the pre-rendered chunks of the tile layers that use the given
+ * \a tileset, or of all tile layers when no tileset is given, and
+ * repaints those layers.
+ */
+void MapItem::invalidateTileLayerCaches(Tileset *tileset)
+{
+    for (LayerItem *item : qAsConst(mLayerItems)) {
+        Layer *layer = item->layer();
+        if (!layer->isTileLayer())
+            continue;
+        if (tileset && !layer->referencesTileset(tileset))
+            continue;
+
+        static_cast<TileLayerItem*>(item)->invalidateCache();
+        item->update();
+    }
+}
+
 /**
  * Inserts map object items for the given objects.
  */
@@ -658,6 +697,10 @@ void MapItem::setObjectLineWidth(qreal lineWidth)
 {
     mapDocument()->renderer()->setObjectLineWidth(lineWidth);
 
+    // Affects the tile collision shapes drawn on tile layers
+    if (mapDocument()->renderer()->testFlag(ShowTileCollisionShapes))
+        invalidateTileLayerCaches();
+
     // Changing the line width can change the size of the object items
     for (MapObjectItem *item : qAsConst(mObjectItems)) {
         if (item->mapObject()->cell().isEmpty()) {
@@ -116,6 +116,8 @@ private:
     void tileObjectGroupChanged(Tile *tile);
 
     void tilesetReplaced(int index, Tileset *tileset);
+    void tilesetImagesChanged(Tileset *tileset);
+    void invalidateTileLayerCaches(Tileset *tileset = nullptr);
 
     void objectsInserted(ObjectGroup *objectGroup, int first, int last);
     void deleteObjectItem(MapObject *object);
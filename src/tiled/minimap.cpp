@@ -21,25 +21,41 @@
 
 #include "minimap.h"
 
+#include "changeevents.h"
+#include "containerhelpers.h"
 #include "documentmanager.h"
+#include "geometry.h"
 #include "map.h"
 #include "mapdocument.h"
+#include "mapobject.h"
 #include "maprenderer.h"
 #include "mapscene.h"
 #include "mapview.h"
+#include "objectgroup.h"
+#include "tilelayer.h"
+#include "tilesetmanager.h"
 #include "utils.h"
 #include "zoomable.h"
 
 #include <QCursor>
+#include <QElapsedTimer>
 #include <QResizeEvent>
 #include <QScrollBar>
-#include <QUndoStack>
 
 using namespace Tiled;
 
+// Full redraws are split into slices of this many rows of the image
+static const int RenderSliceRows = 32;
+
+// Slices are rendered until this many milliseconds have passed, before
+// returning to the event loop
+static const int RenderSliceTime = 10;
+
 MiniMap::MiniMap(QWidget *parent)
     : QFrame(parent)
     , mMapDocument(nullptr)
+    , mRenderY(0)
+    , mFullRedraw(true)
     , mDragging(false)
     , mMouseMoveCursorState(false)
     , mRedrawMapImage(false)
@@ -58,6 +74,15 @@ MiniMap::MiniMap(QWidget *parent)
     mMapImageUpdateTimer.setSingleShot(true);
     connect(&mMapImageUpdateTimer, &QTimer::timeout,
             this, &MiniMap::redrawTimeout);
+    mRenderSliceTimer.setSingleShot(true);
+    connect(&mRenderSliceTimer, &QTimer::timeout,
+            this, &MiniMap::renderNextSlice);
+
+    connect(TilesetManager::instance(), &TilesetManager::tilesetImagesChanged,
+            this, [this] (Tileset *tileset) {
+        if (mMapDocument && contains(mMapDocument->map()->tilesets(), tileset))
+            scheduleMapImageUpdate();
+    });
 }
 
 void MiniMap::setMapDocument(MapDocument *map)
@@ -74,13 +99,35 @@ void MiniMap::setMapDocument(MapDocument *map)
     mMapDocument = map;
 
     if (mMapDocument) {
-        connect(mMapDocument->undoStack(), &QUndoStack::indexChanged,
-                this, &MiniMap::scheduleMapImageUpdate);
+        // Changes to tiles and to the presence of objects are redrawn
+        // locally, while any other change causes a full redraw
+        connect(mMapDocument, &MapDocument::regionChanged,
+                this, &MiniMap::regionChanged);
+        connect(mMapDocument, &Document::changed,
+                this, &MiniMap::documentChanged);
+
+        connect(mMapDocument, &MapDocument::mapChanged, this, &MiniMap::scheduleMapImageUpdate);
+        connect(mMapDocument, &MapDocument::layerAdded, this, &MiniMap::scheduleMapImageUpdate);
+        connect(mMapDocument, &MapDocument::layerRemoved, this, &MiniMap::scheduleMapImageUpdate);
+        connect(mMapDocument, &MapDocument::tileLayerChanged, this, &MiniMap::scheduleMapImageUpdate);
+        connect(mMapDocument, &MapDocument::tilesetRemoved, this, &MiniMap::scheduleMapImageUpdate);
+        connect(mMapDocument, &MapDocument::tilesetReplaced, this, &MiniMap::scheduleMapImageUpdate);
+        connect(mMapDocument, &MapDocument::objectTemplateReplaced, this, &MiniMap::scheduleMapImageUpdate);
+        connect(mMapDocument, &MapDocument::objectsIndexChanged, this, &MiniMap::scheduleMapImageUpdate);
+        connect(mMapDocument, &MapDocument::tilesetTilePositioningChanged, this, &MiniMap::scheduleMapImageUpdate);
+        connect(mMapDocument, &MapDocument::tileImageSourceChanged, this, &MiniMap::scheduleMapImageUpdate);
 
         if (MapView *mapView = dm->viewForDocument(mMapDocument))
             connect(mapView, &MapView::viewRectChanged, this, [this] { update(); });
     }
 
+    // Drop the image of the previous map, including any that is being rendered
+    mRenderSliceTimer.stop();
+    mRenderImage = QImage();
+    mMapImage = QImage();
+    mMapImageMapSize = QSize();
+    updateImageRect();
+
     scheduleMapImageUpdate();
 }
 
@@ -91,16 +138,96 @@ QSize MiniMap::sizeHint() const
 
 void MiniMap::scheduleMapImageUpdate()
 {
+    mFullRedraw = true;
     mMapImageUpdateTimer.start(100);
 }
 
+/**
+ * Schedules a redraw of the given part of the map, in pixels.
+ */
+void MiniMap::scheduleRegionUpdate(const QRect &mapRect)
+{
+    mDirtyRegion |= mapRect;
+    mMapImageUpdateTimer.start(100);
+}
+
+void MiniMap::regionChanged(const QRegion &region, TileLayer *tileLayer)
+{
+    const MapRenderer *renderer = mMapDocument->renderer();
+    const QMargins margins = mMapDocument->map()->drawMargins();
+    const QPointF offset = tileLayer->totalOffset();
+
+#if QT_VERSION < 0x050800
+    const auto rects = region.rects();
+    for (const QRect &r : rects) {
+#else
+    for (const QRect &r : region) {
+#endif
+        QRectF boundingRect = renderer->boundingRect(r);
+        boundingRect.adjust(-margins.left(),
+                            -margins.top(),
+                            margins.right(),
+                            margins.bottom());
+
+        scheduleRegionUpdate(boundingRect.translated(offset).toAlignedRect());
+    }
+}
+
+void MiniMap::documentChanged(const ChangeEvent &change)
+{
+    switch (change.type) {
+    case ChangeEvent::MapObjectsAdded:
+    case ChangeEvent::MapObjectsAboutToBeRemoved:
+        objectsChanged(static_cast<const MapObjectsEvent&>(change).mapObjects);
+        break;
+    case ChangeEvent::MapObjectAboutToBeAdded:
+    case ChangeEvent::MapObjectAboutToBeRemoved:
+    case ChangeEvent::MapObjectAdded:
+    case ChangeEvent::MapObjectRemoved:
+    case ChangeEvent::MapObjectsRemoved:
+        // Handled by the events for multiple objects
+        break;
+    case ChangeEvent::WangSetAboutToBeAdded:
+    case ChangeEvent::WangSetAboutToBeRemoved:
+    case ChangeEvent::WangSetAdded:
+    case ChangeEvent::WangSetRemoved:
+    case ChangeEvent::WangSetChanged:
+    case ChangeEvent::WangColorAboutToBeRemoved:
+        break;
+    default:
+        // Changed objects need a full redraw as well, since their previous
+        // bounds are no longer known
+        scheduleMapImageUpdate();
+        break;
+    }
+}
+
+void MiniMap::objectsChanged(const QList<MapObject *> &objects)
+{
+    const MapRenderer *renderer = mMapDocument->renderer();
+
+    for (const MapObject *object : objects) {
+        QRectF bounds = renderer->boundingRect(object);
+
+        if (object->rotation() != qreal(0)) {
+            const QPointF origin = renderer->pixelToScreenCoords(object->position());
+            bounds = rotateAt(origin, object->rotation()).mapRect(bounds);
+        }
+
+        if (const ObjectGroup *objectGroup = object->objectGroup())
+            bounds.translate(objectGroup->totalOffset());
+
+        scheduleRegionUpdate(bounds.toAlignedRect());
+    }
+}
+
 void MiniMap::paintEvent(QPaintEvent *pe)
 {
     QFrame::paintEvent(pe);
 
     if (mRedrawMapImage) {
-        renderMapToImage();
         mRedrawMapImage = false;
+        renderMapToImage();
     }
 
     if (mMapImage.isNull() || mImageRect.isEmpty())
@@ -155,37 +282,137 @@ void MiniMap::updateImageRect()
     mImageRect = imageRect;
 }
 
+/**
+ * Updates the minimap image. A full redraw is done in slices, which are
+ * rendered a few at a time so that the UI stays responsive. Otherwise, only
+ * the changed parts of the map are redrawn.
+ */
 void MiniMap::renderMapToImage()
 {
-    if (!mMapDocument) {
-        mMapImage = QImage();
+    // Changes are applied once the running render has finished
+    if (!mRenderImage.isNull())
         return;
-    }
-
-    MiniMapRenderer miniMapRenderer(mMapDocument->map());
 
-    const QSize mapSize = miniMapRenderer.mapSize();
-    if (mapSize.isEmpty()) {
-        mMapImage = QImage();
+    if (!mFullRedraw) {
+        renderDirtyRegion();
         return;
     }
 
+    mFullRedraw = false;
+    mDirtyRegion = QRegion();
+
+    const QSize mapSize = mMapDocument ? MiniMapRenderer(mMapDocument->map()).mapSize()
+                                       : QSize();
+
     // Determine the largest possible scale
     const QSize viewSize = contentsRect().size() * devicePixelRatioF();
-    qreal scale = qMin(static_cast<qreal>(viewSize.width()) / mapSize.width(),
-                       static_cast<qreal>(viewSize.height()) / mapSize.height());
+    qreal scale = mapSize.isEmpty() ? 0 : qMin(static_cast<qreal>(viewSize.width()) / mapSize.width(),
+                                               static_cast<qreal>(viewSize.height()) / mapSize.height());
 
-    // Allocate a new image when the size changed
     const QSize imageSize = mapSize * scale;
-    if (mMapImage.size() != imageSize) {
-        mMapImage = QImage(imageSize, QImage::Format_ARGB32_Premultiplied);
+    if (imageSize.isEmpty()) {
+        mMapImage = QImage();
+        mMapImageMapSize = QSize();
         updateImageRect();
+        return;
+    }
+
+    const Map *map = mMapDocument->map();
+    const QMargins margins = map->computeLayerOffsetMargins();
+
+    mRenderImage = QImage(imageSize, QImage::Format_ARGB32_Premultiplied);
+    mRenderImage.fill(Qt::transparent);
+    mRenderMapSize = mapSize;
+    mRenderMapRect = mMapDocument->renderer()->mapBoundingRect().marginsAdded(margins);
+    mRenderY = mRenderMapRect.top();
+
+    renderNextSlice();
+}
+
+/**
+ * Renders the next slices of a full redraw, and schedules the remaining
+ * ones. Since each slice is rendered from the current state of the map, a
+ * full redraw is started again when the map size changes in between.
+ */
+void MiniMap::renderNextSlice()
+{
+    if (mRenderImage.isNull() || !mMapDocument)
+        return;
+
+    const MiniMapRenderer miniMapRenderer(mMapDocument->map());
+    if (miniMapRenderer.mapSize() != mRenderMapSize) {
+        mRenderImage = QImage();
+        mFullRedraw = true;
+        renderMapToImage();
+        return;
+    }
+
+    const int sliceHeight = qMax(1, mRenderMapSize.height() * RenderSliceRows / mRenderImage.height());
+
+    QElapsedTimer timer;
+    timer.start();
+
+    do {
+        const QRect slice(mRenderMapRect.left(), mRenderY,
+                          mRenderMapRect.width(), sliceHeight);
+        miniMapRenderer.renderToImage(mRenderImage, mRenderFlags, slice);
+        mRenderY += sliceHeight;
+    } while (mRenderY <= mRenderMapRect.bottom() && timer.elapsed() < RenderSliceTime);
+
+    if (mRenderY <= mRenderMapRect.bottom())
+        mRenderSliceTimer.start(0);
+    else
+        renderFinished();
+}
+
+/**
+ * Redraws the parts of the map that changed since the image was rendered.
+ */
+void MiniMap::renderDirtyRegion()
+{
+    if (mDirtyRegion.isEmpty())
+        return;
+
+    const QRegion region = mDirtyRegion;
+    mDirtyRegion = QRegion();
+
+    if (!mMapDocument)
+        return;
+
+    MiniMapRenderer miniMapRenderer(mMapDocument->map());
+
+    // A change in map size affects the scale of the whole image
+    if (mMapImage.isNull() || miniMapRenderer.mapSize() != mMapImageMapSize) {
+        mFullRedraw = true;
+        renderMapToImage();
+        return;
     }
 
-    if (imageSize.isEmpty())
+    // Each call renders all layers, so avoid many calls for scattered changes
+    if (region.rectCount() > 8) {
+        miniMapRenderer.renderToImage(mMapImage, mRenderFlags, region.boundingRect());
         return;
+    }
+
+#if QT_VERSION < 0x050800
+    const auto rects = region.rects();
+    for (const QRect &r : rects)
+#else
+    for (const QRect &r : region)
+#endif
+        miniMapRenderer.renderToImage(mMapImage, mRenderFlags, r);
+}
 
-    miniMapRenderer.renderToImage(mMapImage, mRenderFlags);
+void MiniMap::renderFinished()
+{
+    mMapImage = mRenderImage;
+    mMapImageMapSize = mRenderMapSize;
+    mRenderImage = QImage();
+    updateImageRect();
+
+    // Apply any changes that were made while rendering
+    mRedrawMapImage = mFullRedraw || !mDirtyRegion.isEmpty();
+    update();
 }
 
 void MiniMap::centerViewOnLocalPixel(const QPointF &centerPos, int delta)
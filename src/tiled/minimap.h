@@ -29,7 +29,10 @@
 
 namespace Tiled {
 
+class ChangeEvent;
 class MapDocument;
+class MapObject;
+class TileLayer;
 
 class MiniMap : public QFrame
 {
@@ -59,11 +62,25 @@ protected:
 
 private:
     void redrawTimeout();
+    void scheduleRegionUpdate(const QRect &mapRect);
+    void regionChanged(const QRegion &region, TileLayer *tileLayer);
+    void documentChanged(const ChangeEvent &change);
+    void objectsChanged(const QList<MapObject*> &objects);
+    void renderNextSlice();
+    void renderFinished();
 
     MapDocument *mMapDocument;
     QImage mMapImage;
+    QSize mMapImageMapSize;
     QRect mImageRect;
     QTimer mMapImageUpdateTimer;
+    QTimer mRenderSliceTimer;
+    QImage mRenderImage;        // image being rendered in slices
+    QSize mRenderMapSize;
+    QRect mRenderMapRect;
+    int mRenderY;               // top of the next slice, in map pixels
+    QRegion mDirtyRegion;
+    bool mFullRedraw;
     bool mDragging;
     QPoint mDragOffset;
     bool mMouseMoveCursorState;
@@ -74,6 +91,7 @@ private:
     QPointF mapToScene(QPointF p) const;
     void updateImageRect();
     void renderMapToImage();
+    void renderDirtyRegion();
     void centerViewOnLocalPixel(const QPointF &centerPos, int delta = 0);
 };
 
@@ -58,8 +58,8 @@ PaintTileLayer::PaintTileLayer(MapDocument *mapDocument,
     auto &data = mLayerData[target];
 
     data.mSource.reset(source->clone());
-    data.mErased.reset(new TileLayer);
-    data.mErased->setCells(target->x(), target->y(), target, paintRegion);
+    data.mErased.reset(new TileLayer(QString(), target->position(), QSize()));
+    data.mErased->snapshotChunks(*target, paintRegion.translated(-target->position()));
     data.mX = x;
     data.mY = y;
     data.mPaintedRegion = paintRegion;
@@ -76,7 +76,8 @@ void PaintTileLayer::undo()
     for (const std::pair<TileLayer* const, LayerData> &entry : mLayerData) {
         const LayerData &data = entry.second;
         TilePainter painter(mMapDocument, entry.first);
-        painter.setCells(0, 0, data.mErased.get(), data.mPaintedRegion);
+        painter.setCells(data.mErased->x(), data.mErased->y(),
+                         data.mErased.get(), data.mPaintedRegion);
     }
 
     QUndoCommand::undo(); // undo child commands
@@ -104,26 +105,17 @@ void PaintTileLayer::LayerData::mergeWith(const PaintTileLayer::LayerData &o)
         return;
     }
 
-    const QRegion combinedRegion = mPaintedRegion.united(o.mPaintedRegion);
-    const QRegion newRegion = combinedRegion.subtracted(mPaintedRegion);
-
     // Copy the painted tiles from the other command over
-    mPaintedRegion = combinedRegion;
+    mPaintedRegion = mPaintedRegion.united(o.mPaintedRegion);
     mSource->setCells(o.mX - mSource->x(),
                       o.mY - mSource->y(),
                       o.mSource.get(),
                       o.mPaintedRegion.translated(-mSource->position()));
 
-    // Copy the newly erased tiles from the other command over
-#if QT_VERSION >= 0x050800
-    for (const QRect &rect : newRegion)
-#else
-    const auto rects = newRegion.rects();
-    for (const QRect &rect : rects)
-#endif
-        for (int y = rect.top(); y <= rect.bottom(); ++y)
-            for (int x = rect.left(); x <= rect.right(); ++x)
-                mErased->setCell(x, y, o.mErased->cellAt(x, y));
+    // Take over the erased chunks this command didn't touch yet. The chunks
+    // we already have were taken before any part of the stroke was painted.
+    mErased->snapshotChunks(*o.mErased,
+                            o.mPaintedRegion.translated(-o.mErased->position()));
 }
 
 bool PaintTileLayer::mergeWith(const QUndoCommand *other)
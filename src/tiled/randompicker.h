@@ -20,7 +20,7 @@
 
 #pragma once
 
-#include <QMap>
+#include <QVector>
 
 #include <random>
 
@@ -35,6 +35,12 @@ inline std::default_random_engine &globalRandomEngine()
 /**
  * A class that helps pick random things that each have a probability
  * assigned.
+ *
+ * The values are stored in flat arrays. When picking repeatedly, an alias
+ * table is set up so that each pick takes constant time.
+ *
+ * A random engine can be passed to pick() and take(), for example to get
+ * reproducible results. By default the globalRandomEngine() is used.
  */
 template<typename T, typename Real = qreal>
 class RandomPicker
@@ -48,56 +54,141 @@ public:
     {
         if (probability > 0) {
             mSum += probability;
-            mThresholds.insert(mSum, value);
+            mValues.append(value);
+            mProbabilities.append(probability);
+            mAlias.clear();
         }
     }
 
     bool isEmpty() const
     {
-        return mThresholds.isEmpty();
+        return mValues.isEmpty();
     }
 
     const T &pick() const
+    {
+        return pick(globalRandomEngine());
+    }
+
+    template<typename Engine>
+    const T &pick(Engine &engine) const
     {
         Q_ASSERT(!isEmpty());
 
-        if (mThresholds.size() == 1)
-            return mThresholds.first();
+        if (mValues.size() == 1)
+            return mValues.first();
 
-        std::uniform_real_distribution<Real> dis(0, mSum);
-        const Real random = dis(globalRandomEngine());
-        auto it = mThresholds.lowerBound(random);
-        if (it == mThresholds.end())
-            --it;
+        if (mAlias.isEmpty())
+            setupAliasTable();
+
+        std::uniform_int_distribution<int> indexDis(0, mValues.size() - 1);
+        std::uniform_real_distribution<Real> dis(0, 1);
+        const int index = indexDis(engine);
 
-        return it.value();
+        if (dis(engine) < mAliasProbabilities.at(index))
+            return mValues.at(index);
+        return mValues.at(mAlias.at(index));
     }
 
     //same as pick, but removes the selected element.
     T take()
+    {
+        return take(globalRandomEngine());
+    }
+
+    template<typename Engine>
+    T take(Engine &engine)
     {
         Q_ASSERT(!isEmpty());
 
+        // Usually only few values are taken, so a linear scan is cheaper
+        // than setting up the alias table.
         std::uniform_real_distribution<Real> dis(0, mSum);
-        const Real random = dis(globalRandomEngine());
-        auto it = mThresholds.lowerBound(random);
-        if (it == mThresholds.end())
-            --it;
+        Real random = dis(engine);
+
+        int index = 0;
+        for (const int last = mValues.size() - 1; index < last; ++index) {
+            random -= mProbabilities.at(index);
+            if (random < 0)
+                break;
+        }
+
+        const T result = mValues.at(index);
+
+        // Remove the value by moving the last one into its place
+        mSum -= mProbabilities.at(index);
+        mValues[index] = mValues.last();
+        mValues.removeLast();
+        mProbabilities[index] = mProbabilities.last();
+        mProbabilities.removeLast();
+        mAlias.clear();
 
-        const T result = it.value();
-        mThresholds.erase(it);
         return result;
     }
 
     void clear()
     {
         mSum = 0.0;
-        mThresholds.clear();
+        mValues.clear();
+        mProbabilities.clear();
+        mAlias.clear();
     }
 
 private:
+    /**
+     * Sets up the alias table using Vose's method. Each slot refers to its
+     * own value with the stored probability and to an alias otherwise.
+     */
+    void setupAliasTable() const
+    {
+        const int count = mValues.size();
+
+        QVector<Real> scaled(count);
+        QVector<int> small;
+        QVector<int> large;
+
+        for (int i = 0; i < count; ++i) {
+            scaled[i] = mProbabilities.at(i) * count / mSum;
+            if (scaled.at(i) < 1)
+                small.append(i);
+            else
+                large.append(i);
+        }
+
+        mAliasProbabilities.resize(count);
+        mAlias.resize(count);
+
+        while (!small.isEmpty() && !large.isEmpty()) {
+            const int less = small.takeLast();
+            const int more = large.takeLast();
+
+            mAliasProbabilities[less] = scaled.at(less);
+            mAlias[less] = more;
+
+            scaled[more] = (scaled.at(more) + scaled.at(less)) - 1;
+            if (scaled.at(more) < 1)
+                small.append(more);
+            else
+                large.append(more);
+        }
+
+        // Remaining slots are (up to rounding errors) full
+        for (int i : qAsConst(large)) {
+            mAliasProbabilities[i] = 1;
+            mAlias[i] = i;
+        }
+        for (int i : qAsConst(small)) {
+            mAliasProbabilities[i] = 1;
+            mAlias[i] = i;
+        }
+    }
+
     Real mSum;
-    QMap<Real, T> mThresholds;
+    QVector<T> mValues;
+    QVector<Real> mProbabilities;
+
+    mutable QVector<Real> mAliasProbabilities;
+    mutable QVector<int> mAlias;    // empty while out of date
 };
 
 } // namespace Tiled
@@ -45,7 +45,7 @@ void SelectSameTileTool::tilePositionChanged(QPoint tilePos)
 
     const bool infinite = mapDocument()->map()->infinite();
 
-    QRegion resultRegion;
+    TileRegion resultRegion;
     if (infinite || tileLayer->contains(tilePos)) {
         const Cell &matchCell = tileLayer->cellAt(tilePos);
         if (matchCell.isEmpty()) {
@@ -53,12 +53,12 @@ void SelectSameTileTool::tilePositionChanged(QPoint tilePos)
             // and because of different desired behavior for infinite vs. fixed
             // maps we need a special handling when matching the empty cell.
             resultRegion = infinite ? tileLayer->bounds() : tileLayer->rect();
-            resultRegion -= tileLayer->region();
+            resultRegion -= tileLayer->tileRegion();
         } else {
-            resultRegion = tileLayer->region([&] (const Cell &cell) { return cell == matchCell; });
+            resultRegion = tileLayer->tileRegion([&] (const Cell &cell) { return cell == matchCell; });
         }
     }
-    setSelectedRegion(resultRegion);
+    setSelectedRegion(resultRegion.toRegion());
     brushItem()->setTileRegion(selectedRegion());
 }
 
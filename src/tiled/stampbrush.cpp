@@ -279,7 +279,7 @@ void StampBrush::updateRandomList()
         mapDocument()->unifyTilesets(*variation.map, mMissingTilesets);
 
         for (auto layer : variation.map->tileLayers())
-            for (const Cell &cell : *static_cast<TileLayer*>(layer))
+            for (const Cell &cell : *static_cast<const TileLayer*>(layer))
                 if (const Tile *tile = cell.tile())
                     mRandomCellPicker.add(cell, tile->probability());
     }
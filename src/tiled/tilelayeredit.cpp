@@ -24,8 +24,13 @@
 #include "editablemap.h"
 #include "editabletile.h"
 #include "editabletilelayer.h"
+#include "editablewangset.h"
+#include "maprenderer.h"
 #include "painttilelayer.h"
 #include "scriptmanager.h"
+#include "wangfiller.h"
+
+#include <QCoreApplication>
 
 namespace Tiled {
 
@@ -58,6 +63,50 @@ void TileLayerEdit::setTile(int x, int y, EditableTile *tile, int flags)
     mChanges.setCell(x, y, cell);
 }
 
+void TileLayerEdit::wangFill(const RegionValueType &region, EditableWangSet *wangSet)
+{
+    wangFill(region.region(), wangSet, false, 0);
+}
+
+void TileLayerEdit::wangFill(const RegionValueType &region, EditableWangSet *wangSet, quint32 seed)
+{
+    wangFill(region.region(), wangSet, true, seed);
+}
+
+/**
+ * Fills the \a region with tiles from the \a wangSet, matching the tiles
+ * currently in the target layer around the region. Large regions are
+ * filled on multiple threads.
+ */
+void TileLayerEdit::wangFill(const QRegion &region, EditableWangSet *wangSet,
+                             bool useSeed, quint32 seed)
+{
+    if (!wangSet) {
+        ScriptManager::instance().throwNullArgError(1);
+        return;
+    }
+
+    EditableMap *map = mTargetLayer->map();
+    if (!map) {
+        ScriptManager::instance().throwError(QCoreApplication::translate("Script Errors", "Layer is not part of a map"));
+        return;
+    }
+
+    const auto renderer = MapRenderer::create(map->map());
+
+    WangFiller wangFiller(*wangSet->wangSet(), renderer.get());
+    wangFiller.setParallelEnabled(true);
+    if (useSeed)
+        wangFiller.setRandomSeed(seed);
+
+    TileLayer filled;
+    wangFiller.fillRegion(filled, *mTargetLayer->tileLayer(), region);
+
+    // The placed cells are marked as checked, like the ones set by setTile
+    mChanges.setCells(0, 0, &filled,
+                      filled.region([] (const Cell &cell) { return cell.checked(); }));
+}
+
 void TileLayerEdit::apply()
 {
     // Applying an edit automatically makes it mergeable, so that further
@@ -21,6 +21,7 @@
 #pragma once
 
 #include "editabletile.h"
+#include "regionvaluetype.h"
 #include "tilelayer.h"
 
 #include <QObject>
@@ -28,6 +29,7 @@
 namespace Tiled {
 
 class EditableTileLayer;
+class EditableWangSet;
 
 class TileLayerEdit : public QObject
 {
@@ -54,9 +56,14 @@ public:
 
 public slots:
     void setTile(int x, int y, EditableTile *tile, int flags = 0);
+    void wangFill(const Tiled::RegionValueType &region, Tiled::EditableWangSet *wangSet);
+    void wangFill(const Tiled::RegionValueType &region, Tiled::EditableWangSet *wangSet, quint32 seed);
     void apply();
 
 private:
+    void wangFill(const QRegion &region, EditableWangSet *wangSet,
+                  bool useSeed, quint32 seed);
+
     EditableTileLayer *mTargetLayer;
     TileLayer mChanges;
     bool mMergeable = false;
@@ -24,14 +24,36 @@
 #include "mapdocument.h"
 #include "maprenderer.h"
 #include "mapview.h"
+#include "preferences.h"
 #include "tile.h"
+#include "tileset.h"
 #include "zoomable.h"
 
 #include <QPainter>
 #include <QStyleOptionGraphicsItem>
+#include <QtMath>
+
+#include <algorithm>
+#include <cmath>
 
 using namespace Tiled;
 
+// Size of the pre-rendered chunks in device pixels
+static const int CacheChunkSize = 256;
+
+// The number of zoom levels for which chunks are cached
+static const int MaxCachedScales = 4;
+
+// Below this scale, the layer is drawn from downscaled levels of detail
+static Preference<qreal> levelOfDetailScale { "Interface/LevelOfDetailScale", 0.25 };
+static const int MaxLevelOfDetail = 12;
+
+static void removeChunks(const QHash<QPoint, QPixmapCache::Key> &chunks)
+{
+    for (const QPixmapCache::Key &key : chunks)
+        QPixmapCache::remove(key);
+}
+
 TileLayerItem::TileLayerItem(TileLayer *layer, MapDocument *mapDocument, QGraphicsItem *parent)
     : LayerItem(layer, parent)
     , mMapDocument(mapDocument)
@@ -41,9 +63,15 @@ TileLayerItem::TileLayerItem(TileLayer *layer, MapDocument *mapDocument, QGraphi
     syncWithTileLayer();
 }
 
+TileLayerItem::~TileLayerItem()
+{
+    invalidateCache();
+}
+
 void TileLayerItem::syncWithTileLayer()
 {
     prepareGeometryChange();
+    invalidateCache();
 
     QRect layerBounds = tileLayer()->bounds();
     if (!mMapDocument->map()->infinite())
@@ -61,11 +89,59 @@ void TileLayerItem::syncWithTileLayer()
     mBoundingRect = boundingRect.marginsAdded(margins);
 }
 
+/**
+ * Drops all pre-rendered chunks of this layer.
+ */
+void TileLayerItem::invalidateCache()
+{
+    for (const CachedChunks &cachedChunks : qAsConst(mCachedChunks))
+        removeChunks(cachedChunks.chunks);
+    for (const CachedChunks &levelOfDetail : qAsConst(mLevelsOfDetail))
+        removeChunks(levelOfDetail.chunks);
+
+    mCachedChunks.clear();
+    mLevelsOfDetail.clear();
+    mUsesAnimatedTilesDirty = true;
+}
+
+/**
+ * Drops the pre-rendered chunks of this layer that overlap the given
+ * \a rect, in item coordinates.
+ */
+void TileLayerItem::invalidateCache(const QRectF &rect)
+{
+    auto invalidate = [&] (CachedChunks &cachedChunks) {
+        auto it = cachedChunks.chunks.begin();
+        while (it != cachedChunks.chunks.end()) {
+            if (cachedChunks.chunkRect(it.key()).intersects(rect)) {
+                QPixmapCache::remove(it.value());
+                it = cachedChunks.chunks.erase(it);
+            } else {
+                ++it;
+            }
+        }
+    };
+
+    std::for_each(mCachedChunks.begin(), mCachedChunks.end(), invalidate);
+    std::for_each(mLevelsOfDetail.begin(), mLevelsOfDetail.end(), invalidate);
+
+    mUsesAnimatedTilesDirty = true;
+}
+
 QRectF TileLayerItem::boundingRect() const
 {
     return mBoundingRect;
 }
 
+/**
+ * Paints the exposed part of the layer using pre-rendered chunks where
+ * possible, so that scrolling doesn't require rendering all tiles again.
+ *
+ * When zoomed out beyond the level of detail scale, the chunks are taken
+ * from the level of detail closest to the current scale. Like the mini-map,
+ * each level is rendered directly at its own scale, so that displaying the
+ * whole map doesn't require rendering it at the level of detail scale first.
+ */
 void TileLayerItem::paint(QPainter *painter,
                           const QStyleOptionGraphicsItem *option,
                           QWidget *widget)
@@ -74,6 +150,148 @@ void TileLayerItem::paint(QPainter *painter,
 
     MapRenderer *renderer = mMapDocument->renderer();
     renderer->setPainterScale(scale);
-    // TODO: Display a border around the layer when selected
-    renderer->drawTileLayer(painter, tileLayer(), option->exposedRect);
+
+    if (!canUseCache(painter)) {
+        // TODO: Display a border around the layer when selected
+        renderer->drawTileLayer(painter, tileLayer(), option->exposedRect);
+        return;
+    }
+
+    QPainter::RenderHints hints = painter->renderHints();
+    const qreal devicePixelRatio = painter->device()->devicePixelRatioF();
+    const qreal deviceScale = painter->transform().m11() * devicePixelRatio;
+    const qreal lodScale = levelOfDetailScale;
+
+    painter->save();
+
+    CachedChunks *cache;
+    if (painter->transform().m11() < lodScale) {
+        const qreal lodDeviceScale = lodScale * devicePixelRatio;
+        const int level = qMin(qFloor(std::log2(lodDeviceScale / deviceScale)), MaxLevelOfDetail);
+        cache = &levelOfDetail(level, lodDeviceScale);
+
+        // The chosen level is at most twice as detailed as needed, and its
+        // tiles are scaled down by a lot
+        painter->setRenderHint(QPainter::SmoothPixmapTransform);
+        hints |= QPainter::SmoothPixmapTransform;
+    } else {
+        cache = &cachedChunks(deviceScale);
+    }
+
+    const qreal chunkSize = cache->chunkSize;
+    const QRectF exposed = option->exposedRect & mBoundingRect;
+    const int startX = qFloor(exposed.left() / chunkSize);
+    const int startY = qFloor(exposed.top() / chunkSize);
+    const int endX = qCeil(exposed.right() / chunkSize);
+    const int endY = qCeil(exposed.bottom() / chunkSize);
+
+    for (int y = startY; y < endY; ++y) {
+        for (int x = startX; x < endX; ++x) {
+            const QPoint chunkPos(x, y);
+            const QPixmap pixmap = chunk(*cache, chunkPos, hints);
+            painter->drawPixmap(cache->chunkRect(chunkPos), pixmap, QRectF(pixmap.rect()));
+        }
+    }
+
+    painter->restore();
+}
+
+/**
+ * Chunks are only cached when the painter merely scales and translates,
+ * and not for layers with animated tiles, which would invalidate the cache
+ * on each frame.
+ */
+bool TileLayerItem::canUseCache(const QPainter *painter) const
+{
+    const QTransform &transform = painter->transform();
+    if (transform.type() > QTransform::TxScale || transform.m11() != transform.m22() || transform.m11() <= 0)
+        return false;
+
+    if (mUsesAnimatedTilesDirty) {
+        mUsesAnimatedTiles = false;
+
+        const auto tilesets = tileLayer()->usedTilesets();
+        for (const SharedTileset &tileset : tilesets) {
+            for (const Tile *tile : tileset->tiles()) {
+                if (tile->isAnimated()) {
+                    mUsesAnimatedTiles = true;
+                    break;
+                }
+            }
+        }
+
+        mUsesAnimatedTilesDirty = false;
+    }
+
+    return !(mUsesAnimatedTiles && mMapDocument->renderer()->testFlag(ShowTileAnimations));
+}
+
+TileLayerItem::CachedChunks &TileLayerItem::cachedChunks(qreal scale)
+{
+    for (CachedChunks &cachedChunks : mCachedChunks)
+        if (cachedChunks.scale == scale)
+            return cachedChunks;
+
+    // Forget the zoom level that was cached first
+    if (mCachedChunks.size() == MaxCachedScales) {
+        removeChunks(mCachedChunks.first().chunks);
+        mCachedChunks.removeFirst();
+    }
+
+    mCachedChunks.append(CachedChunks { scale, CacheChunkSize / scale, {} });
+    return mCachedChunks.last();
+}
+
+/**
+ * Returns the given \a level of detail, where level 0 is rendered at
+ * \a lodScale and each further level at half the scale of the previous.
+ */
+TileLayerItem::CachedChunks &TileLayerItem::levelOfDetail(int level, qreal lodScale)
+{
+    if (!mLevelsOfDetail.isEmpty() && mLevelsOfDetail.first().scale != lodScale) {
+        for (const CachedChunks &levelOfDetail : qAsConst(mLevelsOfDetail))
+            removeChunks(levelOfDetail.chunks);
+        mLevelsOfDetail.clear();
+    }
+
+    while (mLevelsOfDetail.size() <= level) {
+        const int l = mLevelsOfDetail.size();
+        const qreal scale = lodScale / (1 << l);
+        mLevelsOfDetail.append(CachedChunks { scale, CacheChunkSize / scale, {} });
+    }
+
+    return mLevelsOfDetail[level];
+}
+
+/**
+ * Returns the chunk at \a pos from the given \a cache, rendering it when
+ * it isn't cached.
+ */
+QPixmap TileLayerItem::chunk(CachedChunks &cache, QPoint pos, QPainter::RenderHints hints)
+{
+    QPixmap pixmap;
+
+    auto it = cache.chunks.find(pos);
+    if (it != cache.chunks.end() && QPixmapCache::find(it.value(), &pixmap))
+        return pixmap;
+
+    pixmap = renderChunk(cache.chunkRect(pos), cache.scale, hints);
+    cache.chunks.insert(pos, QPixmapCache::insert(pixmap));
+    return pixmap;
+}
+
+QPixmap TileLayerItem::renderChunk(const QRectF &rect, qreal scale,
+                                   QPainter::RenderHints hints) const
+{
+    QPixmap pixmap(CacheChunkSize, CacheChunkSize);
+    pixmap.fill(Qt::transparent);
+
+    QPainter painter(&pixmap);
+    painter.setRenderHints(hints);
+    painter.scale(scale, scale);
+    painter.translate(-rect.topLeft());
+
+    mMapDocument->renderer()->drawTileLayer(&painter, tileLayer(), rect);
+
+    return pixmap;
 }
@@ -24,6 +24,9 @@
 
 #include "tilelayer.h"
 
+#include <QPainter>
+#include <QPixmapCache>
+
 namespace Tiled {
 
 class MapDocument;
@@ -41,6 +44,7 @@ public:
      * @param mapDocument the map document owning the map of this layer
      */
     TileLayerItem(TileLayer *layer, MapDocument *mapDocument, QGraphicsItem *parent = nullptr);
+    ~TileLayerItem() override;
 
     TileLayer *tileLayer() const;
 
@@ -54,6 +58,9 @@ public:
      */
     void syncWithTileLayer();
 
+    void invalidateCache();
+    void invalidateCache(const QRectF &rect);
+
     // QGraphicsItem
     QRectF boundingRect() const override;
     void paint(QPainter *painter,
@@ -61,8 +68,31 @@ public:
                QWidget *widget = nullptr) override;
 
 private:
+    /**
+     * The pre-rendered chunks of this layer at a certain zoom level.
+     */
+    struct CachedChunks
+    {
+        qreal scale;        // including the device pixel ratio
+        qreal chunkSize;    // in item coordinates
+        QHash<QPoint, QPixmapCache::Key> chunks;
+
+        QRectF chunkRect(QPoint pos) const
+        { return QRectF(pos.x() * chunkSize, pos.y() * chunkSize, chunkSize, chunkSize); }
+    };
+
+    bool canUseCache(const QPainter *painter) const;
+    CachedChunks &cachedChunks(qreal scale);
+    CachedChunks &levelOfDetail(int level, qreal lodScale);
+    QPixmap chunk(CachedChunks &cache, QPoint pos, QPainter::RenderHints hints);
+    QPixmap renderChunk(const QRectF &rect, qreal scale, QPainter::RenderHints hints) const;
+
     MapDocument *mMapDocument;
     QRectF mBoundingRect;
+    QVector<CachedChunks> mCachedChunks;
+    QVector<CachedChunks> mLevelsOfDetail;
+    mutable bool mUsesAnimatedTiles = false;
+    mutable bool mUsesAnimatedTilesDirty = true;
 };
 
 inline TileLayer *TileLayerItem::tileLayer() const
@@ -21,10 +21,11 @@
 
 #include "tilepainter.h"
 
+#include "floodfill.h"
 #include "mapdocument.h"
 #include "map.h"
 
-#include <QQueue>
+#include <QtConcurrent/QtConcurrentRun>
 
 using namespace Tiled;
 
@@ -196,166 +197,82 @@ void TilePainter::erase(const QRegion &region)
     emit mMapDocument->regionChanged(paintable, mTileLayer);
 }
 
-static QRegion fillRegion(const TileLayer *layer,
-                          const QRegion &region,
-                          QPoint fillOrigin,
-                          Map::Orientation orientation,
-                          Map::StaggerAxis staggerAxis,
-                          Map::StaggerIndex staggerIndex)
-{
-    // Return empty region when the bounds do not contain the fill origin
-    if (!region.contains(fillOrigin))
-        return QRegion();
-
-    // Cache cell that we will match other cells against
-    const Cell matchCell = layer->cellAt(fillOrigin);
-
-    const QRect bounds = region.boundingRect();
-    const int width = bounds.width();
-    const int height = bounds.height();
-    const int indexOffset = -(bounds.left() + bounds.top() * width);
-
-    const bool isStaggered = orientation == Map::Hexagonal || orientation == Map::Staggered;
-
-    // Create a queue to hold cells that need filling
-    QQueue<QPoint> fillPositions;
-    fillPositions.enqueue(fillOrigin);
-
-    // Create an array that will store which cells have been processed
-    // This is faster than checking if a given cell is in the region/list
-    QVector<bool> processedCellsVec(width * height);
-    bool *processedCells = processedCellsVec.data();
-    QRegion fillRegion;
-
-    // Loop through queued positions and fill them, while at the same time
-    // checking adjacent positions to see if they should be added
-    while (!fillPositions.isEmpty()) {
-        const QPoint currentPoint = fillPositions.dequeue();
-        const int startOfLine = currentPoint.y() * width;
-
-        // Seek as far left as we can
-        int left = currentPoint.x();
-        while (left > bounds.left() && layer->cellAt(left - 1, currentPoint.y()) == matchCell) {
-            --left;
-            processedCells[indexOffset + startOfLine + left] = true;
-        }
-
-        // Seek as far right as we can
-        int right = currentPoint.x();
-        while (right < bounds.right() && layer->cellAt(right + 1, currentPoint.y()) == matchCell) {
-            ++right;
-            processedCells[indexOffset + startOfLine + right] = true;
-        }
-
-        // Add cells between left and right to the region
-        fillRegion += QRegion(left, currentPoint.y(), right - left + 1, 1);
-
-        bool leftColumnIsStaggered = false;
-        bool rightColumnIsStaggered = false;
-
-        // For hexagonal maps with a staggered Y-axis, we may need to extend the search range
-        if (isStaggered) {
-            if (staggerAxis == Map::StaggerY) {
-                bool rowIsStaggered = ((layer->y() + currentPoint.y()) & 1) ^ staggerIndex;
-                if (rowIsStaggered)
-                    right = qMin(right + 1, bounds.right());
-                else
-                    left = qMax(left - 1, bounds.left());
-            } else {
-                leftColumnIsStaggered = ((layer->x() + left) & 1) ^ staggerIndex;
-                rightColumnIsStaggered = ((layer->x() + right) & 1) ^ staggerIndex;
-            }
-        }
-
-        // Loop between left and right and check if cells above or below need
-        // to be added to the queue.
-        auto findFillPositions = [=,&fillPositions](int left, int right, int y) {
-            bool adjacentCellAdded = false;
-
-            for (int x = left; x <= right; ++x) {
-                const int index = y * width + x;
-
-                if (!processedCells[indexOffset + index] && layer->cellAt(x, y) == matchCell) {
-                    // Do not add the cell to the queue if an adjacent cell was added.
-                    if (!adjacentCellAdded) {
-                        fillPositions.enqueue(QPoint(x, y));
-                        adjacentCellAdded = true;
-                    }
-                } else {
-                    adjacentCellAdded = false;
-                }
-
-                processedCells[indexOffset + index] = true;
-            }
-        };
+namespace {
 
-        if (currentPoint.y() > bounds.top()) {
-            int _left = left;
-            int _right = right;
+/**
+ * The data needed to compute a fill region. It is copied from the layer, so
+ * that the computation can run on a worker thread.
+ */
+struct FillParameters
+{
+    FloodFillParameters floodFill;
+    QRegion bounds;                 // in map coordinates
+    QRegion selection;              // in map coordinates
+};
 
-            if (isStaggered && staggerAxis == Map::StaggerX) {
-                if (!leftColumnIsStaggered)
-                    _left = qMax(left - 1, bounds.left());
-                if (!rightColumnIsStaggered)
-                    _right = qMin(right + 1, bounds.right());
-            }
+} // anonymous namespace
 
-            findFillPositions(_left, _right, currentPoint.y() - 1);
-        }
+static FillParameters fillParameters(MapDocument *mapDocument,
+                                     const TileLayer *tileLayer,
+                                     bool paintable)
+{
+    const Map *map = mapDocument->map();
 
-        if (currentPoint.y() < bounds.bottom()) {
-            int _left = left;
-            int _right = right;
+    FillParameters parameters;
+    parameters.floodFill = FloodFillParameters(*tileLayer);
 
-            if (isStaggered && staggerAxis == Map::StaggerX) {
-                if (leftColumnIsStaggered)
-                    _left = qMax(left - 1, bounds.left());
-                if (rightColumnIsStaggered)
-                    _right = qMin(right + 1, bounds.right());
-            }
+    if (paintable) {
+        parameters.selection = mapDocument->selectedArea();
 
-            findFillPositions(_left, _right, currentPoint.y() + 1);
-        }
+        if (map->infinite())
+            parameters.bounds = parameters.selection.isEmpty() ? tileLayer->bounds() : parameters.selection;
+        else
+            parameters.bounds = tileLayer->rect();
+    } else {
+        parameters.bounds = map->infinite() ? tileLayer->bounds() : tileLayer->rect();
     }
 
-    return fillRegion;
+    return parameters;
 }
 
-QRegion TilePainter::computePaintableFillRegion(QPoint fillOrigin) const
+/**
+ * Computes the fill region starting at \a fillOrigin, in map coordinates.
+ */
+static QRegion fillRegion(const FillParameters &parameters,
+                          QPoint fillOrigin,
+                          const std::atomic_bool *canceled = nullptr)
 {
-    const Map *map = mMapDocument->map();
-    const QRegion &selection = mMapDocument->selectedArea();
+    const QPoint layerPosition = parameters.floodFill.layerPosition;
 
-    QRegion bounds;
+    TileRegion region = floodFill(parameters.floodFill,
+                                  parameters.bounds.translated(-layerPosition),
+                                  fillOrigin - layerPosition,
+                                  canceled);
 
-    if (map->infinite())
-        bounds = selection.isEmpty() ? mTileLayer->bounds() : selection;
-    else
-        bounds = mTileLayer->rect();
+    if (!parameters.selection.isEmpty())
+        region &= parameters.selection.translated(-layerPosition);
 
-    QRegion region = fillRegion(mTileLayer,
-                                bounds.translated(-mTileLayer->position()),
-                                fillOrigin - mTileLayer->position(),
-                                map->orientation(), map->staggerAxis(), map->staggerIndex());
+    return region.toRegion().translated(layerPosition);
+}
 
-    region.translate(mTileLayer->position());
+QRegion TilePainter::computePaintableFillRegion(QPoint fillOrigin) const
+{
+    return fillRegion(fillParameters(mMapDocument, mTileLayer, true), fillOrigin);
+}
 
-    if (!selection.isEmpty())
-        region &= selection;
+QFuture<QRegion> TilePainter::computePaintableFillRegionAsync(QPoint fillOrigin,
+                                                              std::shared_ptr<std::atomic_bool> canceled) const
+{
+    const FillParameters parameters = fillParameters(mMapDocument, mTileLayer, true);
 
-    return region;
+    return QtConcurrent::run([=] {
+        return fillRegion(parameters, fillOrigin, canceled.get());
+    });
 }
 
 QRegion TilePainter::computeFillRegion(QPoint fillOrigin) const
 {
-    const Map *map = mMapDocument->map();
-    QRegion bounds = map->infinite() ? mTileLayer->bounds() : mTileLayer->rect();
-    QRegion region = fillRegion(mTileLayer,
-                                bounds.translated(-mTileLayer->position()),
-                                fillOrigin - mTileLayer->position(),
-                                map->orientation(), map->staggerAxis(), map->staggerIndex());
-
-    return region.translated(mTileLayer->position());
+    return fillRegion(fillParameters(mMapDocument, mTileLayer, false), fillOrigin);
 }
 
 bool TilePainter::isDrawable(int x, int y) const
@@ -23,8 +23,12 @@
 
 #include "tilelayer.h"
 
+#include <QFuture>
 #include <QRegion>
 
+#include <atomic>
+#include <memory>
+
 namespace Tiled {
 
 class MapDocument;
@@ -96,6 +100,15 @@ public:
      */
     QRegion computePaintableFillRegion(QPoint fillOrigin) const;
 
+    /**
+     * Computes the paintable fill region like computePaintableFillRegion(),
+     * but on a worker thread. The computation works on a snapshot of the
+     * layer and can be aborted by setting \a canceled, in which case the
+     * resulting region is empty.
+     */
+    QFuture<QRegion> computePaintableFillRegionAsync(QPoint fillOrigin,
+                                                     std::shared_ptr<std::atomic_bool> canceled) const;
+
     /**
      * Computes a fill region made up of all cells of the same type as that
      * at \a fillOrigin that are connected. Does not take into account the
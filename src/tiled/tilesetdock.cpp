@@ -357,7 +357,7 @@ void TilesetDock::selectTilesInStamp(const TileStamp &stamp)
 
     for (const TileStampVariation &variation : stamp.variations())
         for (auto layer : variation.map->tileLayers())
-            for (const Cell &cell : *static_cast<TileLayer*>(layer))
+            for (const Cell &cell : *static_cast<const TileLayer*>(layer))
                 if (Tile *tile = cell.tile())
                     tiles.insert(tile);
 
@@ -26,6 +26,10 @@
 #include "tilelayer.h"
 #include "wangset.h"
 
+#include <QtConcurrent/QtConcurrentMap>
+
+#include <vector>
+
 using namespace Tiled;
 
 static constexpr QPoint aroundTilePoints[WangId::NumIndexes] = {
@@ -172,6 +176,26 @@ void WangFiller::fillRegion(TileLayer &target,
     if (!mMapRenderer->map()->infinite())
         bounds &= back.rect();
 
+    if (mParallelEnabled && !mCorrectionsEnabled) {
+        resolveRegionInParallel(target, back, region, bounds, grid);
+    } else {
+        std::default_random_engine seededEngine(mRandomSeed);
+        auto &engine = mHasRandomSeed ? seededEngine : globalRandomEngine();
+        resolveRegion(target, back, region, bounds, grid, engine);
+    }
+}
+
+/**
+ * Resolves the cells in the given \a region, which may be only part of the
+ * filled region when not making corrections.
+ */
+void WangFiller::resolveRegion(TileLayer &target,
+                               const TileLayer &back,
+                               const QRegion &region,
+                               const QRect &bounds,
+                               Grid<CellInfo> &grid,
+                               std::default_random_engine &engine) const
+{
     // Keep a list of points that need correction
     QVector<QPoint> corrections;
 
@@ -183,7 +207,7 @@ void WangFiller::fillRegion(TileLayer &target,
             return;
 
         Cell cell;
-        if (!findBestMatch(target, grid, QPoint(x, y), cell)) {
+        if (!findBestMatch(target, grid, QPoint(x, y), engine, cell)) {
             // TODO: error feedback
             return;
         }
@@ -246,6 +270,97 @@ void WangFiller::fillRegion(TileLayer &target,
     }
 }
 
+namespace {
+
+struct Stripe
+{
+    QRegion region;
+    QRect rect;         // the stripe including the rows it may affect
+    std::unique_ptr<TileLayer> target;
+    Grid<WangFiller::CellInfo> grid;
+    quint32 index;
+};
+
+} // anonymous namespace
+
+/**
+ * Resolves the \a region in horizontal stripes. First the even stripes are
+ * resolved in parallel, after which the odd stripes are resolved in parallel
+ * to fill the seams in between, taking into account the tiles placed on both
+ * sides.
+ *
+ * Each stripe works on a copy of the grid and its own target layer. The
+ * stripes are far enough apart that the rows each of them affects don't
+ * overlap, so the results are merged back afterwards. Each stripe also uses
+ * its own random engine, so the result doesn't depend on how the stripes
+ * are scheduled.
+ */
+void WangFiller::resolveRegionInParallel(TileLayer &target,
+                                         const TileLayer &back,
+                                         const QRegion &region,
+                                         const QRect &bounds,
+                                         Grid<CellInfo> &grid) const
+{
+    // The margin covers the surrounding points, which may be two rows away
+    // on staggered maps. The height needs to be more than twice the margin.
+    constexpr int StripeHeight = 32;
+    constexpr int StripeMargin = 2;
+
+    const QRect regionRect = region.boundingRect();
+    const int stripeCount = (regionRect.height() + StripeHeight - 1) / StripeHeight;
+
+    const quint32 seed = mHasRandomSeed ? mRandomSeed
+                                        : quint32(globalRandomEngine()());
+
+    // Make sure the lazily computed parts of the WangSet are up to date,
+    // since they can't be updated from multiple threads.
+    mWangSet.isComplete();
+    mWangSet.maximumColorDistance();
+
+    for (int parity = 0; parity < 2; ++parity) {
+        std::vector<Stripe> stripes;
+
+        for (int i = parity; i < stripeCount; i += 2) {
+            const QRect stripeRect(regionRect.left(),
+                                   regionRect.top() + i * StripeHeight,
+                                   regionRect.width(),
+                                   StripeHeight);
+
+            Stripe stripe;
+            stripe.region = region & stripeRect;
+            stripe.rect = stripeRect.adjusted(-StripeMargin, -StripeMargin,
+                                              StripeMargin, StripeMargin);
+            stripe.index = i;
+
+            if (stripe.region.isEmpty())
+                continue;
+
+            // Include the cells placed by neighboring stripes
+            stripe.target = std::make_unique<TileLayer>(QString(), target.position(), target.size());
+            stripe.target->setCells(0, 0, &target, QRegion(stripe.rect.translated(-target.position())));
+            stripe.grid = grid;
+
+            stripes.push_back(std::move(stripe));
+        }
+
+        QtConcurrent::blockingMap(stripes, [&] (Stripe &stripe) {
+            std::seed_seq seedSequence { seed, stripe.index };
+            std::default_random_engine engine(seedSequence);
+            resolveRegion(*stripe.target, back, stripe.region, bounds, stripe.grid, engine);
+        });
+
+        for (const Stripe &stripe : stripes) {
+            const QRect &rect = stripe.rect;
+
+            target.setCells(0, 0, stripe.target.get(), stripe.region.translated(-target.position()));
+
+            for (int y = rect.top(); y <= rect.bottom(); ++y)
+                for (int x = rect.left(); x <= rect.right(); ++x)
+                    grid.set(x, y, stripe.grid.get(x, y));
+        }
+    }
+}
+
 WangId WangFiller::wangIdFromSurroundings(const TileLayer &back,
                                           const QRegion &region,
                                           QPoint point) const
@@ -265,6 +380,7 @@ WangId WangFiller::wangIdFromSurroundings(const TileLayer &back,
 bool WangFiller::findBestMatch(const TileLayer &target,
                                const Grid<CellInfo> &grid,
                                QPoint position,
+                               std::default_random_engine &engine,
                                Cell &result) const
 {
     const CellInfo info = grid.get(position);
@@ -317,8 +433,12 @@ bool WangFiller::findBestMatch(const TileLayer &target,
         }
     };
 
+    // Only look at the WangIds matching the masked part of the desired WangId
+    QVector<int> candidates;
+    mWangSet.findMatchingWangIds(info.desired, info.mask, candidates);
+
     const auto &wangIdsAndCells = mWangSet.wangIdsAndCells();
-    for (int i = 0, i_end = wangIdsAndCells.size(); i < i_end; ++i)
+    for (int i : candidates)
         processCandidate(wangIdsAndCells[i].wangId, wangIdsAndCells[i].cell);
 
     if (mCorrectionsEnabled)
@@ -326,7 +446,7 @@ bool WangFiller::findBestMatch(const TileLayer &target,
 
     // Choose a candidate at random, with consideration for probability
     while (!matches.isEmpty()) {
-        result = matches.take();
+        result = matches.take(engine);
 
         // Check if we will be able to place any Wang tile next to this
         // candidate. This can be a relatively expensive check, that we'll only
@@ -29,6 +29,7 @@
 #include <QPoint>
 
 #include <memory>
+#include <random>
 
 namespace Tiled {
 
@@ -58,6 +59,19 @@ public:
 
     void setCorrectionsEnabled(bool enabled) { mCorrectionsEnabled = enabled; }
 
+    /**
+     * Enables resolving large regions in horizontal stripes on multiple
+     * threads. Has no effect when corrections are enabled.
+     */
+    void setParallelEnabled(bool enabled) { mParallelEnabled = enabled; }
+
+    /**
+     * Sets the seed to use for the random choices, which makes the result
+     * reproducible. This includes the parallel mode, since the stripes don't
+     * depend on the number of threads.
+     */
+    void setRandomSeed(quint32 seed) { mRandomSeed = seed; mHasRandomSeed = true; }
+
     void setDebugPainter(QPainter *painter) { mDebugPainter = painter; }
 
     /**
@@ -80,15 +94,32 @@ private:
                                   const QRegion &region,
                                   QPoint point) const;
 
+    void resolveRegion(TileLayer &target,
+                       const TileLayer &back,
+                       const QRegion &region,
+                       const QRect &bounds,
+                       Grid<CellInfo> &grid,
+                       std::default_random_engine &engine) const;
+
+    void resolveRegionInParallel(TileLayer &target,
+                                 const TileLayer &back,
+                                 const QRegion &region,
+                                 const QRect &bounds,
+                                 Grid<CellInfo> &grid) const;
+
     bool findBestMatch(const TileLayer &target,
                        const Grid<CellInfo> &grid,
                        QPoint position,
+                       std::default_random_engine &engine,
                        Cell &result) const;
 
     const WangSet &mWangSet;
     const MapRenderer * const mMapRenderer;
     const StaggeredRenderer * const mStaggeredRenderer;
     bool mCorrectionsEnabled = false;
+    bool mParallelEnabled = false;
+    bool mHasRandomSeed = false;
+    quint32 mRandomSeed = 0;
 
     QPainter *mDebugPainter = nullptr;
 };
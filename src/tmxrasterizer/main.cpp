@@ -32,6 +32,7 @@
 #include <QCommandLineParser>
 #include <QDebug>
 #include <QGuiApplication>
+#include <QRegularExpression>
 #include <QStringList>
 #include <QUrl>
 
@@ -79,20 +80,32 @@ int main(int argc, char *argv[])
                             QCoreApplication::translate("main", "name") },
                           { "advance-animations",
                             QCoreApplication::translate("main", "If used tile animations are advanced by the specified duration."),
-                            QCoreApplication::translate("main", "duration") }
+                            QCoreApplication::translate("main", "duration") },
+                          { "render-tiles",
+                            QCoreApplication::translate("main", "Splits the output image into COLUMNSxROWS parts, which are rendered in parallel (default: 1x1)."),
+                            QCoreApplication::translate("main", "columnsxrows") },
+                          { "tile-pyramid",
+                            QCoreApplication::translate("main", "Writes a pyramid of 256x256 tiles to the output directory as z/x/y images, instead of a single image. The highest zoom level is rendered at the scale given by --scale, --tilesize or --size.") },
+                          { "tile-format",
+                            QCoreApplication::translate("main", "The image format of the tiles written with --tile-pyramid (default: png)."),
+                            QCoreApplication::translate("main", "format") },
+                          { "batch",
+                            QCoreApplication::translate("main", "Renders all maps listed in the given file, or standard input when \"-\", instead of a single map. Each line lists a map or world and the image to output, separated by a tab."),
+                            QCoreApplication::translate("main", "file") }
                       });
     parser.addPositionalArgument("map|world", QCoreApplication::translate("main", "Map or world file to render."));
-    parser.addPositionalArgument("image", QCoreApplication::translate("main", "Image file to output."));
+    parser.addPositionalArgument("image", QCoreApplication::translate("main", "Image file to output, or directory when using --tile-pyramid."));
     parser.process(app);
 
+    const bool batch = parser.isSet(QLatin1String("batch"));
     const QStringList args = parser.positionalArguments();
-    if (args.size() != 2)
+    if (args.size() != (batch ? 0 : 2))
         parser.showHelp(1);
 
-    const QString &fileToOpen = localFile(args.at(0));
-    const QString &fileToSave = args.at(1);
+    const QString fileToOpen = batch ? QString() : localFile(args.at(0));
+    const QString fileToSave = batch ? QString() : args.at(1);
 
-    if (fileToOpen.isEmpty() || fileToSave.isEmpty())
+    if (!batch && (fileToOpen.isEmpty() || fileToSave.isEmpty()))
         parser.showHelp(1);
 
     TmxRasterizer w;
@@ -138,5 +151,25 @@ int main(int argc, char *argv[])
         }
     }
 
+    w.setTilePyramid(parser.isSet(QLatin1String("tile-pyramid")));
+    if (parser.isSet(QLatin1String("tile-format")))
+        w.setTileFormat(parser.value(QLatin1String("tile-format")));
+
+    if (parser.isSet(QLatin1String("render-tiles"))) {
+        static const QRegularExpression pattern(QLatin1String("^(\\d+)(?:x(\\d+))?$"));
+        const QString value = parser.value(QLatin1String("render-tiles"));
+        const QRegularExpressionMatch match = pattern.match(value);
+        const int columns = match.captured(1).toInt();
+        const int rows = match.captured(2).isEmpty() ? columns : match.captured(2).toInt();
+        if (!match.hasMatch() || columns <= 0 || rows <= 0) {
+            qWarning().noquote() << QCoreApplication::translate("main", "Invalid render-tiles specified: \"%1\"").arg(value);
+            exit(1);
+        }
+        w.setRenderTiles(QSize(columns, rows));
+    }
+
+    if (batch)
+        return w.renderBatch(parser.value(QLatin1String("batch")));
+
     return w.render(fileToOpen, fileToSave);
 }
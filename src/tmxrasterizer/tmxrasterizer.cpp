@@ -34,17 +34,61 @@
 #include "mapreader.h"
 #include "maprenderer.h"
 #include "objectgroup.h"
+#include "tile.h"
 #include "tilelayer.h"
 #include "tilesetmanager.h"
 #include "worldmanager.h"
 
 #include <QDebug>
+#include <QDir>
+#include <QElapsedTimer>
+#include <QFile>
 #include <QImageWriter>
-
+#include <QRegularExpression>
+#include <QTextStream>
+#include <QThreadPool>
+#include <QtConcurrent/QtConcurrentRun>
+#include <QtConcurrent/QtConcurrentMap>
+#include <QtMath>
+
+#include <QtGui/private/qguiapplication_p.h>
+#include <QtGui/qpa/qplatformintegration.h>
+
+#include <atomic>
+#include <cmath>
 #include <memory>
+#include <numeric>
 
 using namespace Tiled;
 
+/**
+ * Returns whether pixmaps, like the tile images, can be used outside of the
+ * GUI thread on the current platform. Rendering in parallel is only done
+ * when they can.
+ */
+static bool canUsePixmapsInThreads()
+{
+    static const bool threadedPixmaps = [] {
+        const QPlatformIntegration *integration = QGuiApplicationPrivate::platformIntegration();
+        const bool supported = integration && integration->hasCapability(QPlatformIntegration::ThreadedPixmaps);
+        if (!supported)
+            qWarning("Pixmaps can't be used outside of the GUI thread on this platform, rendering on a single thread");
+        return supported;
+    }();
+
+    return threadedPixmaps;
+}
+
+/**
+ * Updates the caches the map computes on demand while it is rendered, so
+ * that these are only read when the map is rendered on multiple threads.
+ */
+static void prepareForParallelRendering(const Map &map)
+{
+    map.drawMargins();
+    map.usedTilesets();     // also updates the draw margins of tile layers
+}
+
 TmxRasterizer::TmxRasterizer()
 {
 }
@@ -63,14 +107,19 @@ void TmxRasterizer::drawMapLayers(const MapRenderer &renderer,
         painter.setOpacity(layer->effectiveOpacity());
         painter.translate(offset);
 
+        // Only draw the part of the layer that ends up on the image
+        const QPaintDevice *device = painter.device();
+        const QRectF exposed = painter.transform().inverted().mapRect(
+                    QRectF(0, 0, device->width(), device->height()));
+
         const TileLayer *tileLayer = dynamic_cast<const TileLayer*>(layer);
         const ImageLayer *imageLayer = dynamic_cast<const ImageLayer*>(layer);
         const ObjectGroup *objectGroup = dynamic_cast<const ObjectGroup*>(layer);
 
         if (tileLayer) {
-            renderer.drawTileLayer(&painter, tileLayer);
+            renderer.drawTileLayer(&painter, tileLayer, exposed);
         } else if (imageLayer) {
-            renderer.drawImageLayer(&painter, imageLayer);
+            renderer.drawImageLayer(&painter, imageLayer, exposed);
         } else if (objectGroup) {
             QList<MapObject*> objects = objectGroup->objects();
 
@@ -100,6 +149,61 @@ void TmxRasterizer::drawMapLayers(const MapRenderer &renderer,
     }
 }
 
+/**
+ * Paints on the given \a image using the given \a paint function, which
+ * is passed a painter set up with the given \a transform.
+ *
+ * When rendering in multiple tiles, the image is split into parts that are
+ * painted in parallel. Each part has its own painter, which paints directly
+ * into the memory of the image. The maps painted by \a paint need to have
+ * been prepared using prepareForParallelRendering().
+ */
+void TmxRasterizer::paintImage(QImage &image, const QTransform &transform,
+                               const std::function<void (QPainter &)> &paint) const
+{
+    if (image.isNull())
+        return;
+
+    const int columns = qBound(1, mRenderTiles.width(), image.width());
+    const int rows = qBound(1, mRenderTiles.height(), image.height());
+
+    QVector<QRect> parts;
+    for (int row = 0; row < rows; ++row) {
+        const int top = image.height() * row / rows;
+        const int bottom = image.height() * (row + 1) / rows;
+
+        for (int column = 0; column < columns; ++column) {
+            const int left = image.width() * column / columns;
+            const int right = image.width() * (column + 1) / columns;
+            parts.append(QRect(left, top, right - left, bottom - top));
+        }
+    }
+
+    uchar *bits = image.bits();
+    const int bytesPerLine = image.bytesPerLine();
+    const int bytesPerPixel = image.depth() / 8;
+    const QImage::Format format = image.format();
+
+    auto paintPart = [&] (const QRect &part) {
+        QImage partImage(bits + part.y() * bytesPerLine + part.x() * bytesPerPixel,
+                         part.width(), part.height(), bytesPerLine, format);
+
+        QPainter painter(&partImage);
+        painter.setRenderHint(QPainter::Antialiasing, mUseAntiAliasing);
+        painter.setRenderHint(QPainter::SmoothPixmapTransform, mSmoothImages);
+        painter.setTransform(transform * QTransform::fromTranslate(-part.x(), -part.y()));
+
+        paint(painter);
+    };
+
+    if (parts.size() == 1 || !canUsePixmapsInThreads()) {
+        for (const QRect &part : qAsConst(parts))
+            paintPart(part);
+    } else {
+        QtConcurrent::blockingMap(parts, paintPart);
+    }
+}
+
 bool TmxRasterizer::shouldDrawLayer(const Layer *layer) const
 {
     if (layer->isGroupLayer())
@@ -122,6 +226,9 @@ bool TmxRasterizer::shouldDrawLayer(const Layer *layer) const
 int TmxRasterizer::render(const QString &fileName,
                           const QString &imageFileName)
 {
+    if (mTilePyramid)
+        return renderTilePyramid(fileName, imageFileName);
+
     if (fileName.endsWith(".world", Qt::CaseInsensitive))
         return renderWorld(fileName, imageFileName);
     else
@@ -140,7 +247,17 @@ int TmxRasterizer::renderMap(const QString &mapFileName,
         return 1;
     }
 
-    const auto renderer = MapRenderer::create(map.get());
+    if (mAdvanceAnimations > 0)
+        TilesetManager::instance()->advanceTileAnimations(mAdvanceAnimations);
+
+    const QImage image = renderMapImage(*map);
+    map.reset();
+    return saveImage(imageFileName, image);
+}
+
+QImage TmxRasterizer::renderMapImage(const Map &map) const
+{
+    const auto renderer = MapRenderer::create(&map);
     QRect mapBoundingRect = renderer->mapBoundingRect();
     QSize mapSize = mapBoundingRect.size();
     QPoint mapOffset = mapBoundingRect.topLeft();
@@ -151,16 +268,13 @@ int TmxRasterizer::renderMap(const QString &mapFileName,
         yScale = static_cast<qreal>(mSize) / mapSize.height();
         xScale = yScale = qMin(1.0, qMin(xScale, yScale));
     } else if (mTileSize > 0) {
-        xScale = static_cast<qreal>(mTileSize) / map->tileWidth();
-        yScale = static_cast<qreal>(mTileSize) / map->tileHeight();
+        xScale = static_cast<qreal>(mTileSize) / map.tileWidth();
+        yScale = static_cast<qreal>(mTileSize) / map.tileHeight();
     } else {
         xScale = yScale = mScale;
     }
 
-    if (mAdvanceAnimations > 0) 
-        TilesetManager::instance()->advanceTileAnimations(mAdvanceAnimations);
-
-    QMargins margins = map->computeLayerOffsetMargins();
+    QMargins margins = map.computeLayerOffsetMargins();
     mapSize.setWidth(mapSize.width() + margins.left() + margins.right());
     mapSize.setHeight(mapSize.height() + margins.top() + margins.bottom());
 
@@ -169,18 +283,20 @@ int TmxRasterizer::renderMap(const QString &mapFileName,
 
     QImage image(mapSize, QImage::Format_ARGB32);
     image.fill(Qt::transparent);
-    QPainter painter(&image);
 
-    painter.setRenderHint(QPainter::Antialiasing, mUseAntiAliasing);
-    painter.setRenderHint(QPainter::SmoothPixmapTransform, mSmoothImages);
-    painter.setTransform(QTransform::fromScale(xScale, yScale));
+    QTransform transform = QTransform::fromScale(xScale, yScale);
+    transform.translate(margins.left(), margins.top());
+    transform.translate(-mapOffset.x(), -mapOffset.y());
 
-    painter.translate(margins.left(), margins.top());
-    painter.translate(-mapOffset);
+    // Each painter uses its own renderer, since the parts may be painted on
+    // different threads
+    prepareForParallelRendering(map);
+    paintImage(image, transform, [&] (QPainter &painter) {
+        const auto partRenderer = MapRenderer::create(&map);
+        drawMapLayers(*partRenderer, painter);
+    });
 
-    drawMapLayers(*renderer, painter);
-    map.reset();
-    return saveImage(imageFileName, image);
+    return image;
 }
 
 
@@ -251,13 +367,9 @@ int TmxRasterizer::renderWorld(const QString &worldFileName,
     worldSize.rheight() *= yScale;
     QImage image(worldSize, QImage::Format_ARGB32);
     image.fill(Qt::transparent);
-    QPainter painter(&image);
-
-    painter.setRenderHint(QPainter::Antialiasing, mUseAntiAliasing);
-    painter.setRenderHint(QPainter::SmoothPixmapTransform, mSmoothImages);
-    painter.setTransform(QTransform::fromScale(xScale, yScale));
 
-    painter.translate(-worldBoundingRect.topLeft());
+    QTransform transform = QTransform::fromScale(xScale, yScale);
+    transform.translate(-worldBoundingRect.left(), -worldBoundingRect.top());
 
     for (const World::MapEntry &mapEntry : maps) {
         std::unique_ptr<Map> map { readMap(mapEntry.fileName, &errorString) };
@@ -270,10 +382,452 @@ int TmxRasterizer::renderWorld(const QString &worldFileName,
         if (mAdvanceAnimations > 0) 
             TilesetManager::instance()->advanceTileAnimations(mAdvanceAnimations);
         
-        const auto renderer = MapRenderer::create(map.get());
-        drawMapLayers(*renderer, painter, mapEntry.rect.topLeft());
+        prepareForParallelRendering(*map);
+        paintImage(image, transform, [&] (QPainter &painter) {
+            const auto renderer = MapRenderer::create(map.get());
+            drawMapLayers(*renderer, painter, mapEntry.rect.topLeft());
+        });
         TilesetManager::instance()->resetTileAnimations();
     }
 
     return saveImage(imageFileName, image);
 }
+
+namespace {
+
+struct PyramidMap
+{
+    QString fileName;
+    QPoint offset;
+    QRect bounds;
+};
+
+} // anonymous namespace
+
+/**
+ * Advances the tile animations of the tilesets used by \a map that are not
+ * yet in \a advancedTilesets, and adds them to that set. Used when maps
+ * are loaded one by one, since TilesetManager::advanceTileAnimations only
+ * affects the tilesets that are already loaded.
+ */
+static void advanceTileAnimations(const Map &map, int ms,
+                                  QSet<SharedTileset> &advancedTilesets)
+{
+    for (const SharedTileset &tileset : map.tilesets()) {
+        if (advancedTilesets.contains(tileset))
+            continue;
+
+        advancedTilesets.insert(tileset);
+
+        for (Tile *tile : tileset->tiles())
+            tile->advanceAnimation(ms);
+    }
+}
+
+static const int PyramidTileSize = 256;
+
+/**
+ * Renders the given map or world as a pyramid of 256x256 tiles, written to
+ * "z/x/y.<format>" within the \a outputDirectory. The highest zoom level is
+ * rendered at the configured scale and each lower level is scaled down
+ * from the level above it, until the whole map or world fits in one tile.
+ *
+ * Tiles are rendered in parallel, one row at a time, so that only the maps
+ * intersecting the current row need to be kept in memory. Fully empty tiles
+ * are not written.
+ */
+int TmxRasterizer::renderTilePyramid(const QString &fileName,
+                                     const QString &outputDirectory)
+{
+    QString errorString;
+    QVector<World::MapEntry> mapEntries;
+
+    if (fileName.endsWith(".world", Qt::CaseInsensitive)) {
+        const World *world = WorldManager::instance().loadWorld(fileName, &errorString);
+        if (!world) {
+            qWarning("Error loading the world file \"%s\":\n%s",
+                     qUtf8Printable(fileName),
+                     qUtf8Printable(errorString));
+            return 1;
+        }
+        mapEntries = world->allMaps();
+    } else {
+        mapEntries.append(World::MapEntry { fileName, QRect() });
+    }
+
+    // Determine the bounds of all maps
+    QVector<PyramidMap> maps;
+    QRect boundingRect;
+    QSize tileSize;
+    for (const World::MapEntry &mapEntry : qAsConst(mapEntries)) {
+        std::unique_ptr<Map> map { readMap(mapEntry.fileName, &errorString) };
+        if (!map) {
+            qWarning("Error while reading \"%s\":\n%s",
+                     qUtf8Printable(mapEntry.fileName),
+                     qUtf8Printable(errorString));
+            continue;
+        }
+
+        const auto renderer = MapRenderer::create(map.get());
+        QRect mapBoundingRect = renderer->mapBoundingRect();
+        mapBoundingRect.translate(mapEntry.rect.topLeft());
+
+        boundingRect |= mapBoundingRect;
+        if (tileSize.isEmpty())
+            tileSize = map->tileSize();
+        maps.append(PyramidMap { mapEntry.fileName, mapEntry.rect.topLeft(), mapBoundingRect });
+    }
+
+    if (maps.isEmpty() || boundingRect.isEmpty()) {
+        qWarning("Error: Nothing to rasterize in \"%s\"",
+                 qUtf8Printable(fileName));
+        return 1;
+    }
+
+    const QDir dir(outputDirectory);
+    auto tilePath = [&] (int z, int x, int y) {
+        return dir.filePath(QStringLiteral("%1/%2/%3.%4").arg(z).arg(x).arg(y).arg(mTileFormat));
+    };
+    auto makeColumnDirectories = [&] (int z, int columns) {
+        for (int x = 0; x < columns; ++x) {
+            const QString path = QStringLiteral("%1/%2").arg(z).arg(x);
+            if (!dir.mkpath(path)) {
+                qWarning("Error creating directory \"%s\"",
+                         qUtf8Printable(dir.filePath(path)));
+                return false;
+            }
+        }
+        return true;
+    };
+
+    std::atomic<bool> failed { false };
+    auto saveTile = [&] (const QImage &image, int z, int x, int y) {
+        if (saveImage(tilePath(z, x, y), image) != 0)
+            failed = true;
+    };
+
+    // The tiles are square, so the scale is the same in both directions. For
+    // --tilesize it is based on the larger dimension of the first map's tiles.
+    const int boundingSize = qMax(boundingRect.width(), boundingRect.height());
+    qreal scale = mScale;
+    if (mSize > 0)
+        scale = qMin(1.0, static_cast<qreal>(mSize) / boundingSize);
+    else if (mTileSize > 0 && !tileSize.isEmpty())
+        scale = static_cast<qreal>(mTileSize) / qMax(tileSize.width(), tileSize.height());
+
+    // Choose the number of levels so that everything fits in one tile at 0
+    const qreal scaledSize = boundingSize * scale;
+    const int maxZoom = qMax(0, qCeil(std::log2(scaledSize / PyramidTileSize)));
+    const qreal tileWorldSize = PyramidTileSize / scale;
+
+    int columns = qCeil(boundingRect.width() / tileWorldSize);
+    int rows = qCeil(boundingRect.height() / tileWorldSize);
+
+    if (!makeColumnDirectories(maxZoom, columns))
+        return 1;
+
+    QVector<int> tileColumns(columns);
+    std::iota(tileColumns.begin(), tileColumns.end(), 0);
+
+    QHash<QString, std::shared_ptr<const Map>> loadedMaps;
+
+    for (int y = 0; y < rows; ++y) {
+        const QRectF rowRect(boundingRect.left(),
+                             boundingRect.top() + y * tileWorldSize,
+                             boundingRect.width(),
+                             tileWorldSize);
+
+        // The tilesets of the loaded maps have had their animations advanced
+        QSet<SharedTileset> advancedTilesets;
+        if (mAdvanceAnimations > 0) {
+            for (const auto &map : qAsConst(loadedMaps))
+                for (const SharedTileset &tileset : map->tilesets())
+                    advancedTilesets.insert(tileset);
+        }
+
+        // Load the maps needed for this row, keeping those already loaded
+        QHash<QString, std::shared_ptr<const Map>> rowMaps;
+        for (const PyramidMap &pyramidMap : qAsConst(maps)) {
+            if (!rowRect.intersects(pyramidMap.bounds))
+                continue;
+
+            std::shared_ptr<const Map> map = loadedMaps.value(pyramidMap.fileName);
+            if (!map) {
+                map = readMap(pyramidMap.fileName, &errorString);
+                if (map) {
+                    prepareForParallelRendering(*map);
+                    if (mAdvanceAnimations > 0)
+                        advanceTileAnimations(*map, mAdvanceAnimations, advancedTilesets);
+                }
+            }
+            if (map)
+                rowMaps.insert(pyramidMap.fileName, map);
+        }
+        loadedMaps.swap(rowMaps);
+        rowMaps.clear();
+
+        auto renderTile = [&] (int x) {
+            const QRectF tileRect(rowRect.left() + x * tileWorldSize, rowRect.top(),
+                                  tileWorldSize, tileWorldSize);
+
+            QImage image(PyramidTileSize, PyramidTileSize, QImage::Format_ARGB32_Premultiplied);
+            image.fill(Qt::transparent);
+            bool drawn = false;
+
+            QPainter painter(&image);
+            painter.setRenderHint(QPainter::Antialiasing, mUseAntiAliasing);
+            painter.setRenderHint(QPainter::SmoothPixmapTransform, mSmoothImages);
+
+            for (const PyramidMap &pyramidMap : qAsConst(maps)) {
+                if (!tileRect.intersects(pyramidMap.bounds))
+                    continue;
+
+                const auto map = loadedMaps.value(pyramidMap.fileName);
+                if (!map)
+                    continue;
+
+                QTransform transform = QTransform::fromScale(scale, scale);
+                transform.translate(-tileRect.left(), -tileRect.top());
+                painter.setTransform(transform);
+
+                const auto renderer = MapRenderer::create(map.get());
+                drawMapLayers(*renderer, painter, pyramidMap.offset);
+                drawn = true;
+            }
+
+            painter.end();
+
+            if (drawn)
+                saveTile(image, maxZoom, x, y);
+        };
+
+        if (canUsePixmapsInThreads()) {
+            QtConcurrent::blockingMap(tileColumns, renderTile);
+        } else {
+            for (int x : qAsConst(tileColumns))
+                renderTile(x);
+        }
+    }
+
+    loadedMaps.clear();
+
+    // Compose the lower zoom levels from the tiles of the level above
+    for (int z = maxZoom - 1; z >= 0; --z) {
+        columns = (columns + 1) / 2;
+        rows = (rows + 1) / 2;
+
+        if (!makeColumnDirectories(z, columns))
+            return 1;
+
+        QVector<QPoint> tiles;
+        tiles.reserve(columns * rows);
+        for (int y = 0; y < rows; ++y)
+            for (int x = 0; x < columns; ++x)
+                tiles.append(QPoint(x, y));
+
+        QtConcurrent::blockingMap(tiles, [&] (const QPoint &tile) {
+            const int half = PyramidTileSize / 2;
+
+            QImage image(PyramidTileSize, PyramidTileSize, QImage::Format_ARGB32_Premultiplied);
+            image.fill(Qt::transparent);
+            bool drawn = false;
+
+            QPainter painter(&image);
+            painter.setRenderHint(QPainter::SmoothPixmapTransform, mSmoothImages);
+
+            for (int j = 0; j < 2; ++j) {
+                for (int i = 0; i < 2; ++i) {
+                    const QImage child(tilePath(z + 1, tile.x() * 2 + i, tile.y() * 2 + j));
+                    if (child.isNull())
+                        continue;
+
+                    painter.drawImage(QRect(i * half, j * half, half, half), child);
+                    drawn = true;
+                }
+            }
+
+            painter.end();
+
+            if (drawn)
+                saveTile(image, z, tile.x(), tile.y());
+        });
+    }
+
+    TilesetManager::instance()->resetTileAnimations();
+
+    return failed ? 1 : 0;
+}
+
+namespace {
+
+struct BatchEntry
+{
+    QString fileName;
+    QString imageFileName;
+    qint64 loadTime = 0;
+    qint64 renderTime = 0;
+    int result = 0;
+};
+
+} // anonymous namespace
+
+/**
+ * Renders each of the maps listed in the given manifest file, or standard
+ * input when the file name is "-". Each line lists an input file and the
+ * output image, separated by a tab, or by whitespace when there is no tab.
+ * Empty lines and lines starting with '#' are ignored.
+ *
+ * Maps are loaded one by one while the loaded maps are rendered in
+ * parallel. Loaded tilesets are kept alive, so that they are shared by the
+ * maps using them, and images are shared through the ImageCache. A summary
+ * of the time spent on each map is printed at the end.
+ */
+int TmxRasterizer::renderBatch(const QString &manifestFileName)
+{
+    QFile file;
+    bool opened;
+    if (manifestFileName == QLatin1String("-")) {
+        opened = file.open(stdin, QIODevice::ReadOnly | QIODevice::Text);
+    } else {
+        file.setFileName(manifestFileName);
+        opened = file.open(QIODevice::ReadOnly | QIODevice::Text);
+    }
+
+    if (!opened) {
+        qWarning("Error opening \"%s\": %s",
+                 qUtf8Printable(manifestFileName),
+                 qUtf8Printable(file.errorString()));
+        return 1;
+    }
+
+    static const QRegularExpression whitespace(QStringLiteral("\\s+"));
+
+    QVector<BatchEntry> entries;
+    int invalidLines = 0;
+    QTextStream stream(&file);
+    for (int lineNumber = 1; !stream.atEnd(); ++lineNumber) {
+        const QString line = stream.readLine().trimmed();
+        if (line.isEmpty() || line.startsWith(QLatin1Char('#')))
+            continue;
+
+        QStringList parts;
+        const int tab = line.indexOf(QLatin1Char('\t'));
+        if (tab != -1)
+            parts = QStringList { line.left(tab).trimmed(), line.mid(tab + 1).trimmed() };
+        else
+            parts = line.split(whitespace);
+
+        if (parts.size() != 2 || parts.at(0).isEmpty() || parts.at(1).isEmpty()) {
+            qWarning("Invalid line %d in \"%s\"",
+                     lineNumber,
+                     qUtf8Printable(manifestFileName));
+            ++invalidLines;
+            continue;
+        }
+
+        BatchEntry entry;
+        entry.fileName = parts.at(0);
+        entry.imageFileName = parts.at(1);
+        entries.append(entry);
+    }
+
+    QElapsedTimer totalTimer;
+    totalTimer.start();
+
+    // Keeps the tilesets loaded for the following maps
+    QSet<SharedTileset> tilesets;
+
+    const bool parallel = canUsePixmapsInThreads();
+    const int maxRunning = qMax(1, QThreadPool::globalInstance()->maxThreadCount());
+    QList<QFuture<void>> running;
+
+    for (BatchEntry &entry : entries) {
+        QElapsedTimer timer;
+        timer.start();
+
+        // Worlds and tile pyramids are rendered in parallel by themselves.
+        // They also change the state of tile animations, so wait for the
+        // running maps and restore the state afterwards.
+        if (mTilePyramid || entry.fileName.endsWith(QLatin1String(".world"), Qt::CaseInsensitive)) {
+            for (QFuture<void> &future : running)
+                future.waitForFinished();
+            running.clear();
+
+            timer.restart();
+            entry.result = render(entry.fileName, entry.imageFileName);
+            entry.renderTime = timer.elapsed();
+
+            TilesetManager::instance()->resetTileAnimations();
+            if (mAdvanceAnimations > 0)
+                TilesetManager::instance()->advanceTileAnimations(mAdvanceAnimations);
+            continue;
+        }
+
+        // Maps are loaded on this thread, since loading isn't thread-safe
+        QString errorString;
+        std::shared_ptr<const Map> map { readMap(entry.fileName, &errorString) };
+        entry.loadTime = timer.elapsed();
+
+        if (!map) {
+            qWarning("Error while reading \"%s\":\n%s",
+                     qUtf8Printable(entry.fileName),
+                     qUtf8Printable(errorString));
+            entry.result = 1;
+            continue;
+        }
+
+        // Advance only the animations of newly loaded tilesets, since the
+        // others may be in use by maps that are still being rendered
+        if (mAdvanceAnimations > 0) {
+            advanceTileAnimations(*map, mAdvanceAnimations, tilesets);
+        } else {
+            for (const SharedTileset &tileset : map->tilesets())
+                tilesets.insert(tileset);
+        }
+
+        // Limit the number of maps held in memory
+        while (running.size() >= maxRunning)
+            running.takeFirst().waitForFinished();
+
+        BatchEntry *batchEntry = &entry;
+        auto renderEntry = [this, map, batchEntry] () mutable {
+            QElapsedTimer renderTimer;
+            renderTimer.start();
+
+            const QImage image = renderMapImage(*map);
+            map.reset();
+            batchEntry->result = saveImage(batchEntry->imageFileName, image);
+            batchEntry->renderTime = renderTimer.elapsed();
+        };
+
+        if (parallel)
+            running.append(QtConcurrent::run(renderEntry));
+        else
+            renderEntry();
+    }
+
+    for (QFuture<void> &future : running)
+        future.waitForFinished();
+
+    int failed = invalidLines;
+    for (const BatchEntry &entry : qAsConst(entries)) {
+        qInfo("%s: loaded in %lld ms, rendered in %lld ms%s",
+              qUtf8Printable(entry.fileName),
+              entry.loadTime,
+              entry.renderTime,
+              entry.result == 0 ? "" : " (failed)");
+
+        if (entry.result != 0)
+            ++failed;
+    }
+
+    const int count = static_cast<int>(entries.size());
+    qInfo("Rendered %d of %d maps in %lld ms",
+          count - (failed - invalidLines),
+          count,
+          totalTimer.elapsed());
+
+    TilesetManager::instance()->resetTileAnimations();
+
+    return failed > 0 ? 1 : 0;
+}
@@ -32,13 +32,17 @@
 
 #include "map.h"
 #include "mapreader.h"
+#include <QSize>
 #include <QString>
 #include <QStringList>
 
+#include <functional>
+
 using namespace Tiled;
 
 class QImage;
 class QPainter;
+class QTransform;
 
 class TmxRasterizer
 {
@@ -52,6 +56,9 @@ public:
     bool useAntiAliasing() const { return mUseAntiAliasing; }
     bool smoothImages() const { return mSmoothImages; }
     bool ignoreVisibility() const { return mIgnoreVisibility; }
+    QSize renderTiles() const { return mRenderTiles; }
+    bool tilePyramid() const { return mTilePyramid; }
+    QString tileFormat() const { return mTileFormat; }
 
     void setScale(qreal scale) { mScale = scale; }
     void setTileSize(int tileSize) { mTileSize = tileSize; }
@@ -60,11 +67,15 @@ public:
     void setAntiAliasing(bool useAntiAliasing) { mUseAntiAliasing = useAntiAliasing; }
     void setSmoothImages(bool smoothImages) { mSmoothImages = smoothImages; }
     void setIgnoreVisibility(bool IgnoreVisibility) { mIgnoreVisibility = IgnoreVisibility; }
+    void setRenderTiles(QSize renderTiles) { mRenderTiles = renderTiles; }
+    void setTilePyramid(bool tilePyramid) { mTilePyramid = tilePyramid; }
+    void setTileFormat(const QString &tileFormat) { mTileFormat = tileFormat; }
 
     void setLayersToHide(QStringList layersToHide) { mLayersToHide = layersToHide; }
     void setLayersToShow(QStringList layersToShow) { mLayersToShow = layersToShow; }
 
     int render(const QString &fileName, const QString &imageFileName);
+    int renderBatch(const QString &manifestFileName);
 
 private:
     qreal mScale = 1.0;
@@ -74,12 +85,19 @@ private:
     bool mUseAntiAliasing = false;
     bool mSmoothImages = true;
     bool mIgnoreVisibility = false;
+    QSize mRenderTiles { 1, 1 };
+    bool mTilePyramid = false;
+    QString mTileFormat = QStringLiteral("png");
     QStringList mLayersToHide;
     QStringList mLayersToShow;
 
     void drawMapLayers(const MapRenderer &renderer, QPainter &painter, QPoint mapOffset = QPoint(0, 0)) const;
+    void paintImage(QImage &image, const QTransform &transform,
+                    const std::function<void (QPainter &)> &paint) const;
     int renderMap(const QString &mapFileName, const QString &imageFileName);
+    QImage renderMapImage(const Map &map) const;
     int renderWorld(const QString &worldFileName, const QString &imageFileName);
+    int renderTilePyramid(const QString &fileName, const QString &outputDirectory);
     int saveImage(const QString &imageFileName, const QImage &image) const;
     bool shouldDrawLayer(const Layer *layer) const;
 };
@@ -2,6 +2,7 @@ include(../../tiled.pri)
 include(../libtiled/libtiled.pri)
 
 TEMPLATE = app
+QT += concurrent gui-private
 TARGET = tmxrasterizer
 target.path = $${PREFIX}/bin
 INSTALLS += target
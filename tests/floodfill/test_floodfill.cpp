@@ -0,0 +1,168 @@
+#include "floodfill.h"
+#include "tileset.h"
+
+#include <QtTest/QtTest>
+
+using namespace Tiled;
+
+class test_FloodFill : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void fill_data();
+    void fill();
+
+    void missingChunks();
+    void originOutsideRegion();
+    void canceled();
+};
+
+/**
+ * Sets up a layer from the given rows, where '#' is a wall and any other
+ * character an empty cell. '@' marks the fill origin and 'o' the other cells
+ * that are expected to get filled.
+ */
+struct TestMap
+{
+    explicit TestMap(const QStringList &rows)
+        : tileset(Tileset::create(QStringLiteral("Walls"), 32, 32))
+        , layer(QString(), 0, 0, rows.first().size(), rows.size())
+    {
+        for (int y = 0; y < rows.size(); ++y) {
+            for (int x = 0; x < rows.at(y).size(); ++x) {
+                switch (rows.at(y).at(x).toLatin1()) {
+                case '#':
+                    layer.setCell(x, y, Cell(tileset.data(), 0));
+                    break;
+                case '@':
+                    origin = QPoint(x, y);
+                    expected += QRect(x, y, 1, 1);
+                    break;
+                case 'o':
+                    expected += QRect(x, y, 1, 1);
+                    break;
+                }
+            }
+        }
+    }
+
+    SharedTileset tileset;
+    TileLayer layer;
+    QPoint origin;
+    QRegion expected;
+};
+
+void test_FloodFill::fill_data()
+{
+    QTest::addColumn<int>("orientation");
+    QTest::addColumn<int>("staggerAxis");
+    QTest::addColumn<int>("staggerIndex");
+    QTest::addColumn<QStringList>("rows");
+
+    const QStringList enclosed {
+        "........",
+        ".######.",
+        ".#@oo##.",
+        ".#oo#.#.",
+        ".#####..",
+        "........",
+    };
+    const QStringList diagonal {
+        "@o#.",
+        "oo#.",
+        "##..",
+    };
+
+    QTest::newRow("orthogonal-enclosed") << int(Map::Orthogonal) << int(Map::StaggerY) << int(Map::StaggerOdd) << enclosed;
+    QTest::newRow("orthogonal-diagonal") << int(Map::Orthogonal) << int(Map::StaggerY) << int(Map::StaggerOdd) << diagonal;
+
+    // Rows are staggered: odd rows are shifted to the right for StaggerOdd
+    QTest::newRow("staggered-y-odd") << int(Map::Staggered) << int(Map::StaggerY) << int(Map::StaggerOdd) << QStringList {
+        "#@##",
+        "o#.#",
+        "#o##",
+    };
+    QTest::newRow("staggered-y-even") << int(Map::Staggered) << int(Map::StaggerY) << int(Map::StaggerEven) << QStringList {
+        "#@##",
+        ".#o#",
+        "##o#",
+    };
+    QTest::newRow("hexagonal-y-odd") << int(Map::Hexagonal) << int(Map::StaggerY) << int(Map::StaggerOdd) << QStringList {
+        "##@o#",
+        "#o#o#",
+        ".##oo",
+    };
+
+    // Columns are staggered: odd columns are shifted down for StaggerOdd
+    QTest::newRow("hexagonal-x-odd") << int(Map::Hexagonal) << int(Map::StaggerX) << int(Map::StaggerOdd) << QStringList {
+        "#o#o",
+        "@#o#",
+        "#.#.",
+    };
+    QTest::newRow("hexagonal-x-even") << int(Map::Hexagonal) << int(Map::StaggerX) << int(Map::StaggerEven) << QStringList {
+        "#.#.",
+        "@#o#",
+        "#o#o",
+    };
+    QTest::newRow("hexagonal-x-span") << int(Map::Hexagonal) << int(Map::StaggerX) << int(Map::StaggerOdd) << QStringList {
+        "#o##.",
+        "#@oo#",
+        "##o#o",
+    };
+}
+
+void test_FloodFill::fill()
+{
+    QFETCH(int, orientation);
+    QFETCH(int, staggerAxis);
+    QFETCH(int, staggerIndex);
+    QFETCH(QStringList, rows);
+
+    const TestMap map(rows);
+
+    FloodFillParameters parameters(map.layer);
+    parameters.orientation = static_cast<Map::Orientation>(orientation);
+    parameters.staggerAxis = static_cast<Map::StaggerAxis>(staggerAxis);
+    parameters.staggerIndex = static_cast<Map::StaggerIndex>(staggerIndex);
+
+    const TileRegion region = floodFill(parameters, map.layer.rect(), map.origin);
+    QCOMPARE(region.toRegion(), map.expected);
+}
+
+void test_FloodFill::missingChunks()
+{
+    SharedTileset tileset = Tileset::create(QStringLiteral("Walls"), 32, 32);
+    TileLayer layer;
+    for (int y = -40; y < 40; ++y)
+        layer.setCell(20, y, Cell(tileset.data(), 0));
+
+    // Most of the filled area is not covered by any chunk
+    const QRect bounds(-70, -40, 140, 80);
+    const TileRegion region = floodFill(FloodFillParameters(layer), bounds, QPoint(-3, 5));
+    QCOMPARE(region.toRegion(), QRegion(-70, -40, 90, 80));
+
+    // Filling the wall only fills the wall
+    const TileRegion wall = floodFill(FloodFillParameters(layer), bounds, QPoint(20, 0));
+    QCOMPARE(wall.toRegion(), QRegion(20, -40, 1, 80));
+}
+
+void test_FloodFill::originOutsideRegion()
+{
+    const TestMap map({ "@." });
+    const TileRegion region = floodFill(FloodFillParameters(map.layer),
+                                        QRect(1, 0, 1, 1), map.origin);
+    QVERIFY(region.isEmpty());
+}
+
+void test_FloodFill::canceled()
+{
+    const TestMap map({ "@o", "oo" });
+    const std::atomic_bool canceled { true };
+    const TileRegion region = floodFill(FloodFillParameters(map.layer),
+                                        map.layer.rect(), map.origin, &canceled);
+    QVERIFY(region.isEmpty());
+}
+
+QTEST_MAIN(test_FloodFill)
+#include "test_floodfill.moc"
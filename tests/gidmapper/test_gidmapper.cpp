@@ -0,0 +1,251 @@
+#include "gidmapper.h"
+#include "map.h"
+#include "tilelayer.h"
+#include "tileset.h"
+
+#include <QtTest/QtTest>
+
+#include <memory>
+
+using namespace Tiled;
+
+class test_GidMapper : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void cellToGid();
+    void roundTrip();
+    void decodeLayerRow();
+
+    void decodeLayerData_data();
+    void decodeLayerData();
+
+    void encodeLayerData_data();
+    void encodeLayerData();
+
+    void encodeLayerDataInParallel();
+};
+
+static const int TilesPerTileset = 100;
+
+static QVector<SharedTileset> createTilesets(int count)
+{
+    QVector<SharedTileset> tilesets;
+    for (int i = 0; i < count; ++i) {
+        SharedTileset tileset = Tileset::create(QStringLiteral("Tileset %1").arg(i), 32, 32);
+        tileset->setNextTileId(TilesPerTileset);
+        tilesets.append(tileset);
+    }
+    return tilesets;
+}
+
+void test_GidMapper::cellToGid()
+{
+    const auto tilesets = createTilesets(3);
+    const GidMapper gidMapper(tilesets);
+
+    QCOMPARE(gidMapper.cellToGid(Cell()), 0u);
+    QCOMPARE(gidMapper.cellToGid(Cell(tilesets[0].data(), 0)), 1u);
+    QCOMPARE(gidMapper.cellToGid(Cell(tilesets[1].data(), 5)), 1u + TilesPerTileset + 5);
+    QCOMPARE(gidMapper.cellToGid(Cell(tilesets[2].data(), 99)), 1u + TilesPerTileset * 2 + 99);
+
+    Cell flipped(tilesets[1].data(), 0);
+    flipped.setFlippedHorizontally(true);
+    QCOMPARE(gidMapper.cellToGid(flipped), (1u + TilesPerTileset) | 0x80000000);
+
+    // Unknown tilesets map to 0
+    const SharedTileset unknown = Tileset::create(QStringLiteral("Unknown"), 32, 32);
+    QCOMPARE(gidMapper.cellToGid(Cell(unknown.data(), 1)), 0u);
+
+    // The lowest first GID wins when a tileset is inserted twice
+    GidMapper duplicates;
+    duplicates.insert(50, tilesets[0]);
+    duplicates.insert(10, tilesets[0]);
+    QCOMPARE(duplicates.cellToGid(Cell(tilesets[0].data(), 1)), 11u);
+
+    // Replacing the tileset at a first GID forgets the previous tileset
+    duplicates.insert(10, tilesets[1]);
+    QCOMPARE(duplicates.cellToGid(Cell(tilesets[0].data(), 1)), 51u);
+    QCOMPARE(duplicates.cellToGid(Cell(tilesets[1].data(), 1)), 11u);
+
+    duplicates.clear();
+    QCOMPARE(duplicates.cellToGid(Cell(tilesets[1].data(), 1)), 0u);
+}
+
+void test_GidMapper::roundTrip()
+{
+    const auto tilesets = createTilesets(8);
+    const GidMapper gidMapper(tilesets);
+
+    for (unsigned gid = 1; gid <= 8 * TilesPerTileset; gid += 7) {
+        bool ok;
+        const Cell cell = gidMapper.gidToCell(gid, ok);
+        QVERIFY(ok);
+        QCOMPARE(gidMapper.cellToGid(cell), gid);
+    }
+}
+
+void test_GidMapper::decodeLayerRow()
+{
+    const auto tilesets = createTilesets(2);
+    const GidMapper gidMapper(tilesets);
+
+    // A row crossing several chunks, starting at a negative coordinate
+    const int count = 40;
+    QVector<unsigned> gids(count);
+    for (int i = 0; i < count; ++i)
+        gids[i] = (i % 3 == 0) ? 0 : 1 + i * 5;
+
+    TileLayer tileLayer(QString(), 0, 0, 0, 0);
+    QCOMPARE(gidMapper.decodeLayerRow(tileLayer, -7, -3, gids.constData(), count),
+             GidMapper::NoError);
+
+    for (int i = 0; i < count; ++i)
+        QCOMPARE(gidMapper.cellToGid(tileLayer.cellAt(i - 7, -3)), gids[i]);
+
+    QCOMPARE(tileLayer.usedTilesets().size(), 2);
+
+    const unsigned invalid[] = { 1, 2 * TilesPerTileset + 1 + 0x80000000 };
+    QCOMPARE(GidMapper().decodeLayerRow(tileLayer, 0, 0, invalid, 2),
+             GidMapper::TileButNoTilesets);
+
+    GidMapper partial;
+    partial.insert(10, tilesets[0]);
+    QCOMPARE(partial.decodeLayerRow(tileLayer, 0, 0, invalid, 2),
+             GidMapper::InvalidTile);
+    QCOMPARE(partial.invalidTile(), invalid[0]);
+}
+
+void test_GidMapper::decodeLayerData_data()
+{
+    QTest::addColumn<Map::LayerDataFormat>("format");
+
+    QTest::newRow("base64") << Map::Base64;
+    QTest::newRow("gzip") << Map::Base64Gzip;
+    QTest::newRow("zlib") << Map::Base64Zlib;
+}
+
+void test_GidMapper::decodeLayerData()
+{
+    QFETCH(Map::LayerDataFormat, format);
+
+    const auto tilesets = createTilesets(4);
+    const GidMapper gidMapper(tilesets);
+
+    // Large enough to require decoding in multiple blocks
+    const QRect bounds(-16, 32, 200, 150);
+    TileLayer tileLayer(QString(), 0, 0, 0, 0);
+    for (int y = bounds.top(); y <= bounds.bottom(); ++y)
+        for (int x = bounds.left(); x <= bounds.right(); ++x)
+            if ((x * y) % 7 != 0)
+                tileLayer.setCell(x, y, Cell(tilesets[(x + y) & 3].data(), qAbs(x * 31 + y) % TilesPerTileset));
+
+    const QByteArray data = gidMapper.encodeLayerData(tileLayer, format, bounds);
+
+    // Decoding as text should ignore whitespace, like in a TMX file
+    QString text = QString::fromLatin1(data);
+    for (int i = text.size() - 76; i > 0; i -= 76)
+        text.insert(i, QLatin1String("\n   "));
+
+    TileLayer decoded(QString(), 0, 0, 0, 0);
+    QCOMPARE(gidMapper.decodeLayerData(decoded, text.constData(), text.size(), format, bounds),
+             GidMapper::NoError);
+    QVERIFY(decoded.computeDiffRegion(&tileLayer).isEmpty());
+
+    TileLayer fromBytes(QString(), 0, 0, 0, 0);
+    QCOMPARE(gidMapper.decodeLayerData(fromBytes, data, format, bounds),
+             GidMapper::NoError);
+    QVERIFY(fromBytes.computeDiffRegion(&tileLayer).isEmpty());
+
+    // Too little or too much data should be detected
+    TileLayer corrupt(QString(), 0, 0, 0, 0);
+    QCOMPARE(gidMapper.decodeLayerData(corrupt, data, format, bounds.adjusted(0, 0, 0, 1)),
+             GidMapper::CorruptLayerData);
+    QCOMPARE(gidMapper.decodeLayerData(corrupt, data, format, bounds.adjusted(0, 0, 0, -1)),
+             GidMapper::CorruptLayerData);
+    QCOMPARE(gidMapper.decodeLayerData(corrupt, data.left(data.size() / 2), format, bounds),
+             GidMapper::CorruptLayerData);
+}
+
+void test_GidMapper::encodeLayerData_data()
+{
+    QTest::addColumn<int>("tilesetCount");
+
+    QTest::newRow("1 tileset") << 1;
+    QTest::newRow("8 tilesets") << 8;
+    QTest::newRow("64 tilesets") << 64;
+    QTest::newRow("256 tilesets") << 256;
+}
+
+void test_GidMapper::encodeLayerData()
+{
+    QFETCH(int, tilesetCount);
+
+    const int size = 256;
+    const auto tilesets = createTilesets(tilesetCount);
+    const GidMapper gidMapper(tilesets);
+
+    TileLayer tileLayer(QString(), 0, 0, size, size);
+    for (int y = 0; y < size; ++y) {
+        for (int x = 0; x < size; ++x) {
+            const int index = x + y * size;
+            tileLayer.setCell(x, y, Cell(tilesets[index % tilesetCount].data(),
+                                         index % TilesPerTileset));
+        }
+    }
+
+    QByteArray data;
+    QBENCHMARK {
+        data = gidMapper.encodeLayerData(tileLayer, Map::Base64);
+    }
+
+    TileLayer decoded(QString(), 0, 0, size, size);
+    QCOMPARE(gidMapper.decodeLayerData(decoded, data, Map::Base64, decoded.rect()),
+             GidMapper::NoError);
+    QVERIFY(decoded.computeDiffRegion(&tileLayer).isEmpty());
+}
+
+void test_GidMapper::encodeLayerDataInParallel()
+{
+    const auto tilesets = createTilesets(2);
+
+    Map map(Map::Orthogonal, 0, 0, 32, 32);
+    map.setInfinite(true);
+    for (const SharedTileset &tileset : tilesets)
+        map.addTileset(tileset);
+
+    for (int i = 0; i < 3; ++i) {
+        auto tileLayer = std::make_unique<TileLayer>(QString(), 0, 0, 0, 0);
+        for (int y = -20; y < 50; ++y)
+            for (int x = -40; x < 30; x += i + 1)
+                tileLayer->setCell(x, y, Cell(tilesets[(x + y) & 1].data(), qAbs(x * y) % TilesPerTileset));
+        map.addLayer(std::move(tileLayer));
+    }
+
+    const QSize chunkSize(16, 16);
+    const GidMapper gidMapper(tilesets);
+    const EncodedLayerData encoded = gidMapper.encodeLayerDataInParallel(map, Map::Base64Zlib, chunkSize);
+    QVERIFY(!encoded.isEmpty());
+
+    // The data encoded in parallel should be identical
+    for (const Layer *layer : map.tileLayers()) {
+        auto tileLayer = static_cast<const TileLayer*>(layer);
+        const auto chunks = tileLayer->sortedChunksToWrite(chunkSize);
+        QVERIFY(!chunks.isEmpty());
+
+        for (const QRect &rect : chunks) {
+            QCOMPARE(encoded.find(*tileLayer, Map::Base64Zlib, rect, -1),
+                     gidMapper.encodeLayerData(*tileLayer, Map::Base64Zlib, rect));
+        }
+    }
+
+    // Data encoded in another format or for other bounds isn't found
+    auto tileLayer = static_cast<const TileLayer*>(map.layerAt(0));
+    const QRect rect = tileLayer->sortedChunksToWrite(chunkSize).first();
+    QVERIFY(encoded.find(*tileLayer, Map::Base64Gzip, rect, -1).isNull());
+    QVERIFY(encoded.find(*tileLayer, Map::Base64Zlib, rect.adjusted(0, 0, 1, 0), -1).isNull());
+}
+
+QTEST_MAIN(test_GidMapper)
+#include "test_gidmapper.moc"
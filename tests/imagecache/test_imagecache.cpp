@@ -0,0 +1,76 @@
+#include "imagecache.h"
+
+#include <QtTest/QtTest>
+
+using namespace Tiled;
+
+class test_ImageCache : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void tintedHit();
+    void tintedMiss();
+    void removeDropsTinted();
+};
+
+static QPixmap createPixmap()
+{
+    QPixmap pixmap(16, 16);
+    pixmap.fill(Qt::gray);
+    return pixmap;
+}
+
+void test_ImageCache::tintedHit()
+{
+    const QPixmap pixmap = createPixmap();
+    const QColor color(255, 0, 0, 128);
+
+    const TintCacheStatistics before = ImageCache::tintCacheStatistics();
+    const QPixmap first = ImageCache::tinted(pixmap, color);
+    const QPixmap second = ImageCache::tinted(pixmap, color);
+    const TintCacheStatistics after = ImageCache::tintCacheStatistics();
+
+    QCOMPARE(after.misses, before.misses + 1);
+    QCOMPARE(after.hits, before.hits + 1);
+    QCOMPARE(second.cacheKey(), first.cacheKey());
+    QVERIFY(after.hitRate() > 0.0);
+}
+
+void test_ImageCache::tintedMiss()
+{
+    const QPixmap pixmap = createPixmap();
+
+    ImageCache::tinted(pixmap, QColor(0, 255, 0));
+
+    const TintCacheStatistics before = ImageCache::tintCacheStatistics();
+    ImageCache::tinted(pixmap, QColor(0, 0, 255));
+    const TintCacheStatistics after = ImageCache::tintCacheStatistics();
+
+    QCOMPARE(after.hits, before.hits);
+    QCOMPARE(after.misses, before.misses + 1);
+    QCOMPARE(after.count, before.count + 1);
+}
+
+void test_ImageCache::removeDropsTinted()
+{
+    const QPixmap pixmap = createPixmap();
+    const QColor color(255, 255, 0);
+
+    ImageCache::tinted(pixmap, color);
+    QVERIFY(ImageCache::tintCacheStatistics().count > 0);
+
+    ImageCache::remove(QStringLiteral("tileset.png"));
+    QCOMPARE(ImageCache::tintCacheStatistics().count, 0);
+
+    // Tinting again needs to recompute the pixmap
+    const TintCacheStatistics before = ImageCache::tintCacheStatistics();
+    ImageCache::tinted(pixmap, color);
+    const TintCacheStatistics after = ImageCache::tintCacheStatistics();
+
+    QCOMPARE(after.hits, before.hits);
+    QCOMPARE(after.misses, before.misses + 1);
+}
+
+QTEST_MAIN(test_ImageCache)
+#include "test_imagecache.moc"
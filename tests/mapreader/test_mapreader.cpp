@@ -4,6 +4,7 @@
 #include "tilelayer.h"
 #include "mapreader.h"
 
+#include <QBuffer>
 #include <QtTest/QtTest>
 
 using namespace Tiled;
@@ -14,6 +15,9 @@ class test_MapReader : public QObject
 
 private slots:
     void loadMap();
+
+    void loadCsvLayer_data();
+    void loadCsvLayer();
 };
 
 void test_MapReader::loadMap()
@@ -53,5 +57,56 @@ void test_MapReader::loadMap()
     QCOMPARE(mapObject->height(), qreal(64));
 }
 
+void test_MapReader::loadCsvLayer_data()
+{
+    QTest::addColumn<int>("size");
+
+    QTest::newRow("64x64") << 64;
+    QTest::newRow("512x512") << 512;
+    QTest::newRow("2048x2048") << 2048;
+}
+
+void test_MapReader::loadCsvLayer()
+{
+    QFETCH(int, size);
+
+    QByteArray csv;
+    for (int y = 0; y < size; ++y) {
+        csv.append('\n');
+        for (int x = 0; x < size; ++x) {
+            csv.append(QByteArray::number((x + y) % 101));
+            if (x < size - 1 || y < size - 1)
+                csv.append(',');
+        }
+    }
+
+    QByteArray tmx;
+    tmx.append("<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n");
+    tmx.append("<map version=\"1.5\" orientation=\"orthogonal\" renderorder=\"right-down\" ");
+    tmx.append("width=\"" + QByteArray::number(size) + "\" height=\"" + QByteArray::number(size) + "\" ");
+    tmx.append("tilewidth=\"32\" tileheight=\"32\" infinite=\"0\">\n");
+    tmx.append("<tileset firstgid=\"1\" name=\"tiles\" tilewidth=\"32\" tileheight=\"32\" tilecount=\"100\" columns=\"10\"/>\n");
+    tmx.append("<layer id=\"1\" name=\"Ground\" width=\"" + QByteArray::number(size) + "\" height=\"" + QByteArray::number(size) + "\">\n");
+    tmx.append("<data encoding=\"csv\">" + csv + "\n</data>\n");
+    tmx.append("</layer>\n</map>\n");
+
+    std::unique_ptr<Map> map;
+
+    QBENCHMARK {
+        QBuffer buffer(&tmx);
+        buffer.open(QIODevice::ReadOnly);
+
+        MapReader reader;
+        map = reader.readMap(&buffer);
+        QVERIFY2(map.get(), qPrintable(reader.errorString()));
+    }
+
+    const TileLayer *tileLayer = map->layerAt(0)->asTileLayer();
+    QVERIFY(tileLayer);
+    QVERIFY(tileLayer->cellAt(0, 0).isEmpty());
+    QCOMPARE(tileLayer->cellAt(1, 0).tileId(), 0);
+    QCOMPARE(tileLayer->cellAt(size - 1, size - 1).tileId(), (2 * size - 2) % 101 - 1);
+}
+
 QTEST_MAIN(test_MapReader)
 #include "test_mapreader.moc"
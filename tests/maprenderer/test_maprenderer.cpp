@@ -0,0 +1,143 @@
+#include "map.h"
+#include "maprenderer.h"
+#include "tilelayer.h"
+#include "tileset.h"
+
+#include <QtTest/QtTest>
+
+#include <memory>
+
+using namespace Tiled;
+
+Q_DECLARE_METATYPE(Map::Orientation)
+
+class test_MapRenderer : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void drawTileSpans_data();
+    void drawTileSpans();
+
+    void traverseTileLayer_data();
+    void traverseTileLayer();
+};
+
+static std::unique_ptr<Map> createMap(Map::Orientation orientation, const SharedTileset &tileset)
+{
+    Map::Parameters parameters;
+    parameters.orientation = orientation;
+    parameters.width = 200;
+    parameters.height = 200;
+    parameters.tileWidth = 32;
+    parameters.tileHeight = orientation == Map::Orthogonal ? 32 : 16;
+    parameters.hexSideLength = orientation == Map::Hexagonal ? 8 : 0;
+
+    auto map = std::make_unique<Map>(parameters);
+    map->addTileset(tileset);
+
+    auto tileLayer = std::make_unique<TileLayer>(QString(), 0, 0, map->width(), map->height());
+    for (int y = 0; y < map->height(); ++y)
+        for (int x = 0; x < map->width(); ++x)
+            if ((x * y) % 3 != 0)
+                tileLayer->setCell(x, y, Cell(tileset.data(), (x + y) % 16));
+    map->addLayer(std::move(tileLayer));
+
+    return map;
+}
+
+static void addOrientations()
+{
+    QTest::addColumn<Map::Orientation>("orientation");
+
+    QTest::newRow("orthogonal") << Map::Orthogonal;
+    QTest::newRow("isometric") << Map::Isometric;
+    QTest::newRow("staggered") << Map::Staggered;
+    QTest::newRow("hexagonal") << Map::Hexagonal;
+}
+
+void test_MapRenderer::drawTileSpans_data()
+{
+    addOrientations();
+}
+
+void test_MapRenderer::drawTileSpans()
+{
+    QFETCH(Map::Orientation, orientation);
+
+    const SharedTileset tileset = Tileset::create(QStringLiteral("Tileset"), 32, 32);
+    const auto map = createMap(orientation, tileset);
+    const auto renderer = MapRenderer::create(map.get());
+    const auto tileLayer = static_cast<const TileLayer*>(map->layerAt(0));
+
+    // All tiles should be visited exactly once when exposing the whole map
+    QHash<QPoint, int> visited;
+    renderer->drawTileSpans([&] (const MapRenderer::TileSpan &span) {
+        tileLayer->forEachCell(span.startTile, span.tileStep, span.count, [&] (int index, const Cell &cell) {
+            QCOMPARE(cell.tileset(), tileset.data());
+            ++visited[span.tilePos(index)];
+        });
+    }, renderer->mapBoundingRect());
+
+    int expectedCount = 0;
+    for (int y = 0; y < map->height(); ++y) {
+        for (int x = 0; x < map->width(); ++x) {
+            if (tileLayer->cellAt(x, y).isEmpty())
+                continue;
+
+            ++expectedCount;
+            QCOMPARE(visited.value(QPoint(x, y)), 1);
+        }
+    }
+    QCOMPARE(visited.size(), expectedCount);
+}
+
+void test_MapRenderer::traverseTileLayer_data()
+{
+    QTest::addColumn<Map::Orientation>("orientation");
+    QTest::addColumn<bool>("spans");
+
+    QTest::newRow("orthogonal, per tile") << Map::Orthogonal << false;
+    QTest::newRow("orthogonal, spans") << Map::Orthogonal << true;
+    QTest::newRow("isometric, per tile") << Map::Isometric << false;
+    QTest::newRow("isometric, spans") << Map::Isometric << true;
+    QTest::newRow("staggered, per tile") << Map::Staggered << false;
+    QTest::newRow("staggered, spans") << Map::Staggered << true;
+    QTest::newRow("hexagonal, per tile") << Map::Hexagonal << false;
+    QTest::newRow("hexagonal, spans") << Map::Hexagonal << true;
+}
+
+void test_MapRenderer::traverseTileLayer()
+{
+    QFETCH(Map::Orientation, orientation);
+    QFETCH(bool, spans);
+
+    const SharedTileset tileset = Tileset::create(QStringLiteral("Tileset"), 32, 32);
+    const auto map = createMap(orientation, tileset);
+    const auto renderer = MapRenderer::create(map.get());
+    const auto tileLayer = static_cast<const TileLayer*>(map->layerAt(0));
+    const QRectF exposed = renderer->mapBoundingRect();
+
+    qreal sum = 0;
+
+    QBENCHMARK {
+        if (spans) {
+            renderer->drawTileSpans([&] (const MapRenderer::TileSpan &span) {
+                tileLayer->forEachCell(span.startTile, span.tileStep, span.count, [&] (int index, const Cell &cell) {
+                    sum += span.screenPos(index).x() + cell.tileId();
+                });
+            }, exposed);
+        } else {
+            renderer->drawTileLayer([&] (QPoint tilePos, const QPointF &screenPos) {
+                const Cell cell = tileLayer->cellAt(tilePos);
+                if (!cell.isEmpty())
+                    sum += screenPos.x() + cell.tileId();
+            }, exposed);
+        }
+    }
+
+    QVERIFY(sum > 0);
+}
+
+QTEST_MAIN(test_MapRenderer)
+#include "test_maprenderer.moc"
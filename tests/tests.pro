@@ -1,4 +1,11 @@
 TEMPLATE=subdirs
 SUBDIRS = \
+    floodfill \
+    gidmapper \
+    imagecache \
+    maprenderer \
     mapreader \
-    staggeredrenderer
+    staggeredrenderer \
+    tilelayer \
+    tileregion \
+    wangset
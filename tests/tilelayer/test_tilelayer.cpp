@@ -0,0 +1,182 @@
+#include "tilelayer.h"
+#include "tileset.h"
+
+#include <QtTest/QtTest>
+
+#include <memory>
+
+using namespace Tiled;
+
+class test_TileLayer : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void compact();
+    void modifyCompact();
+    void chunkDrawMargins();
+    void modifyThroughIterators();
+    void snapshotChunks();
+};
+
+static std::unique_ptr<TileLayer> createLayer(const QVector<SharedTileset> &tilesets)
+{
+    auto tileLayer = std::make_unique<TileLayer>(QString(), 0, 0, 0, 0);
+    for (int y = -10; y < 40; ++y) {
+        for (int x = -20; x < 30; ++x) {
+            if ((x + y) % 5 == 0)
+                continue;
+
+            Cell cell(tilesets[qAbs(x * y) % tilesets.size()].data(), qAbs(x * 7 + y));
+            cell.setFlippedHorizontally(x & 1);
+            cell.setFlippedAntiDiagonally(y & 1);
+            tileLayer->setCell(x, y, cell);
+        }
+    }
+    return tileLayer;
+}
+
+static QVector<SharedTileset> createTilesets(int count)
+{
+    QVector<SharedTileset> tilesets;
+    for (int i = 0; i < count; ++i)
+        tilesets.append(Tileset::create(QStringLiteral("Tileset %1").arg(i), 32, 32));
+    return tilesets;
+}
+
+void test_TileLayer::compact()
+{
+    const auto tilesets = createTilesets(3);
+    const auto expanded = createLayer(tilesets);
+    const auto compacted = createLayer(tilesets);
+    compacted->compact();
+
+    QVERIFY(compacted->computeDiffRegion(expanded.get()).isEmpty());
+    QCOMPARE(compacted->region(), expanded->region());
+
+    for (int y = -10; y < 40; ++y) {
+        for (int x = -20; x < 30; ++x) {
+            const Cell a = compacted->cellAt(x, y);
+            const Cell b = expanded->cellAt(x, y);
+            QCOMPARE(a.tileset(), b.tileset());
+            QCOMPARE(a.tileId(), b.tileId());
+            QCOMPARE(a.flippedHorizontally(), b.flippedHorizontally());
+            QCOMPARE(a.flippedAntiDiagonally(), b.flippedAntiDiagonally());
+        }
+    }
+
+    // Chunks that can't be packed are left expanded
+    const Chunk *chunk = compacted->findChunk(0, 0);
+    QVERIFY(chunk && chunk->isCompact());
+
+    compacted->setCell(1, 1, Cell(tilesets[0].data(), 1 << 20));
+    QVERIFY(!chunk->isCompact());
+    compacted->compact();
+    QVERIFY(!chunk->isCompact());
+    QCOMPARE(compacted->cellAt(1, 1).tileId(), 1 << 20);
+}
+
+void test_TileLayer::modifyCompact()
+{
+    const auto tilesets = createTilesets(2);
+    const auto tileLayer = createLayer(tilesets);
+    tileLayer->compact();
+
+    tileLayer->replaceReferencesToTileset(tilesets[0].data(), tilesets[1].data());
+    QVERIFY(!tileLayer->hasCell([&] (const Cell &cell) { return cell.tileset() == tilesets[0].data(); }));
+    QVERIFY(tileLayer->findChunk(0, 0)->isCompact());
+
+    tileLayer->removeReferencesToTileset(tilesets[1].data());
+    QVERIFY(tileLayer->isEmpty());
+}
+
+void test_TileLayer::chunkDrawMargins()
+{
+    const SharedTileset small = Tileset::create(QStringLiteral("Small"), 16, 16);
+    const SharedTileset large = Tileset::create(QStringLiteral("Large"), 64, 32);
+    large->setTileOffset(QPoint(4, -8));
+
+    TileLayer tileLayer(QString(), 0, 0, 0, 0);
+    tileLayer.setCell(1, 1, Cell(small.data(), 0));
+    tileLayer.setCell(20, 1, Cell(large.data(), 0));
+
+    const Chunk *chunk = tileLayer.findChunk(1, 1);
+    QCOMPARE(chunk->drawMargins(), QMargins(0, 16, 16, 0));
+
+    // The used tilesets are updated when modifying the chunk
+    tileLayer.setCell(2, 2, Cell(large.data(), 0));
+    QVERIFY(chunk->tilesets().contains(large.data()));
+    QCOMPARE(chunk->drawMargins(), QMargins(0, 72, 68, 0));
+
+    // And remain known when compacted
+    tileLayer.compact();
+    QVERIFY(chunk->isCompact());
+    QCOMPARE(chunk->drawMargins(), QMargins(0, 72, 68, 0));
+
+    tileLayer.removeReferencesToTileset(large.data());
+    QCOMPARE(chunk->drawMargins(), QMargins(0, 16, 16, 0));
+    QCOMPARE(tileLayer.findChunk(20, 1)->drawMargins(), QMargins());
+
+    // Overwriting the last cell using a tileset removes it from the palette
+    tileLayer.setCell(3, 3, Cell(large.data(), 0));
+    QVERIFY(chunk->tilesets().contains(large.data()));
+    tileLayer.setCell(3, 3, Cell(small.data(), 1));
+    QVERIFY(!chunk->tilesets().contains(large.data()));
+    QCOMPARE(chunk->drawMargins(), QMargins(0, 16, 16, 0));
+}
+
+void test_TileLayer::modifyThroughIterators()
+{
+    const auto tilesets = createTilesets(2);
+    const auto tileLayer = createLayer(tilesets);
+    tileLayer->compact();
+
+    for (auto it = tileLayer->begin(), it_end = tileLayer->end(); it != it_end; ++it) {
+        const QPoint pos = it.key();
+        *it = Cell(tilesets[1].data(), qAbs(pos.x() + pos.y()));
+    }
+
+    for (int y = -10; y < 40; ++y)
+        for (int x = -20; x < 30; ++x)
+            QCOMPARE(tileLayer->cellAt(x, y).tileId(), qAbs(x + y));
+
+    // The dirty palette is rebuilt when needed
+    const Chunk *chunk = tileLayer->findChunk(0, 0);
+    QVERIFY(!chunk->isCompact());
+    QCOMPARE(chunk->tilesets(), QVector<Tileset*> { tilesets[1].data() });
+
+    tileLayer->setCell(0, 0, Cell(tilesets[0].data(), 0));
+    QCOMPARE(chunk->tilesets().size(), 2);
+
+    tileLayer->compact();
+    QVERIFY(chunk->isCompact());
+    QCOMPARE(chunk->tilesets().size(), 2);
+    QCOMPARE(tileLayer->cellAt(0, 0).tileset(), tilesets[0].data());
+}
+
+void test_TileLayer::snapshotChunks()
+{
+    const auto tilesets = createTilesets(2);
+    const auto tileLayer = createLayer(tilesets);
+    const auto original = createLayer(tilesets);
+
+    // Includes a chunk that doesn't exist yet
+    const QRegion region = QRegion(-5, -5, 10, 10).united(QRect(40, 40, 2, 2));
+
+    TileLayer snapshot(QString(), 0, 0, 0, 0);
+    snapshot.snapshotChunks(*tileLayer, region);
+
+    for (int y = -5; y < 5; ++y)
+        for (int x = -5; x < 5; ++x)
+            tileLayer->setCell(x, y, Cell(tilesets[1].data(), 3));
+    tileLayer->setCell(41, 41, Cell(tilesets[0].data(), 1));
+
+    // Taking another snapshot doesn't replace the existing chunks
+    snapshot.snapshotChunks(*tileLayer, region);
+
+    tileLayer->setCells(0, 0, &snapshot, region);
+    QVERIFY(tileLayer->computeDiffRegion(original.get()).isEmpty());
+}
+
+QTEST_MAIN(test_TileLayer)
+#include "test_tilelayer.moc"
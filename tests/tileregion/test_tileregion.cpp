@@ -0,0 +1,123 @@
+#include "tileregion.h"
+
+#include <QtTest/QtTest>
+
+using namespace Tiled;
+
+class test_TileRegion : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void rects();
+    void booleanOperations();
+    void translate();
+
+    void unite_data();
+    void unite();
+};
+
+/**
+ * Returns a noisy region, spanning multiple blocks including ones at
+ * negative coordinates.
+ */
+static QRegion noisyRegion(const QRect &bounds, int seed)
+{
+    QRegion region;
+    for (int y = bounds.top(); y <= bounds.bottom(); ++y)
+        for (int x = bounds.left(); x <= bounds.right(); ++x)
+            if (((x * 7 + y * 13 + seed) % 5) < 2 || (y + seed) % 23 == 0)
+                region += QRect(x, y, 1, 1);
+    return region;
+}
+
+void test_TileRegion::rects()
+{
+    const QRegion region = noisyRegion(QRect(-70, -10, 140, 80), 1) + QRect(-200, 100, 400, 300);
+    const TileRegion tileRegion(region);
+
+    QCOMPARE(tileRegion.toRegion(), region);
+    QCOMPARE(tileRegion.boundingRect(), region.boundingRect());
+
+    // The rectangles should be banded like those of a QRegion
+    const QVector<QRect> rects = tileRegion.rects();
+    for (int i = 1; i < rects.size(); ++i) {
+        const QRect &a = rects.at(i - 1);
+        const QRect &b = rects.at(i);
+        QVERIFY(a.top() < b.top() || (a.top() == b.top() && a.right() + 1 < b.left()));
+        if (a.top() == b.top())
+            QCOMPARE(a.height(), b.height());
+    }
+
+    int count = 0;
+    for (const QRect &rect : rects)
+        count += rect.width() * rect.height();
+    QCOMPARE(tileRegion.count(), count);
+
+    QVERIFY(tileRegion.contains(-200, 399));
+    QVERIFY(!tileRegion.contains(-201, 399));
+}
+
+void test_TileRegion::booleanOperations()
+{
+    const QRegion a = noisyRegion(QRect(-70, -10, 140, 80), 1);
+    const QRegion b = noisyRegion(QRect(-30, 20, 120, 70), 2);
+    const TileRegion tileA(a);
+    const TileRegion tileB(b);
+
+    QCOMPARE((tileA | tileB).toRegion(), a | b);
+    QCOMPARE((tileA & tileB).toRegion(), a & b);
+    QCOMPARE((tileA - tileB).toRegion(), a - b);
+    QCOMPARE((tileA ^ tileB).toRegion(), a ^ b);
+
+    QVERIFY(tileA.intersects(tileB));
+    QVERIFY(!tileA.intersects(TileRegion(QRect(500, 500, 10, 10))));
+
+    QVERIFY((tileA - tileA).isEmpty());
+    QVERIFY(TileRegion(a | b) == (tileA | tileB));
+    QVERIFY(tileA != tileB);
+}
+
+void test_TileRegion::translate()
+{
+    const QRegion region = noisyRegion(QRect(-70, -10, 140, 80), 3);
+    const TileRegion tileRegion(region);
+
+    const QPoint offsets[] = { QPoint(64, -128), QPoint(3, -5), QPoint(-100, 61) };
+    for (const QPoint &offset : offsets)
+        QCOMPARE(tileRegion.translated(offset).toRegion(), region.translated(offset));
+}
+
+void test_TileRegion::unite_data()
+{
+    QTest::addColumn<bool>("tileRegion");
+
+    QTest::newRow("QRegion") << false;
+    QTest::newRow("TileRegion") << true;
+}
+
+void test_TileRegion::unite()
+{
+    QFETCH(bool, tileRegion);
+
+    // Uniting many single cells, like when selecting all cells of a certain
+    // tile on a large map
+    QBENCHMARK {
+        if (tileRegion) {
+            TileRegion region;
+            for (int y = 0; y < 256; ++y)
+                for (int x = (y & 1); x < 256; x += 2)
+                    region.add(x, y);
+            QVERIFY(!region.toRegion().isEmpty());
+        } else {
+            QRegion region;
+            for (int y = 0; y < 256; ++y)
+                for (int x = (y & 1); x < 256; x += 2)
+                    region += QRect(x, y, 1, 1);
+            QVERIFY(!region.isEmpty());
+        }
+    }
+}
+
+QTEST_MAIN(test_TileRegion)
+#include "test_tileregion.moc"
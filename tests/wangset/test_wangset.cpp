@@ -0,0 +1,66 @@
+#include "tileset.h"
+#include "wangset.h"
+
+#include <QtTest/QtTest>
+
+using namespace Tiled;
+
+class test_WangSet : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void findMatchingWangIds();
+};
+
+void test_WangSet::findMatchingWangIds()
+{
+    const SharedTileset tileset = Tileset::create(QStringLiteral("Tileset"), 32, 32);
+    tileset->setTransformationFlags(Tileset::AllowFlipHorizontally |
+                                    Tileset::AllowFlipVertically);
+
+    WangSet wangSet(tileset.data(), QStringLiteral("Terrain"), WangSet::Mixed);
+    wangSet.setColorCount(3);
+
+    // Enough tiles to need several words per color in the index
+    for (int tileId = 0; tileId < 100; ++tileId) {
+        WangId wangId;
+        for (int i = 0; i < WangId::NumIndexes; ++i)
+            wangId.setIndexColor(i, (tileId * 7 + i * i * 3 + tileId / 5) % 4);
+        if (wangId)
+            wangSet.setWangId(tileId, wangId);
+    }
+
+    const auto &entries = wangSet.wangIdsAndCells();
+    QVERIFY(entries.size() > 64);
+
+    const WangId masks[] = {
+        WangId::FULL_MASK,
+        WangId::MaskTop | WangId::MaskLeft,
+        WangId::MaskTopLeft,
+        WangId(),
+        WangId(0x0F),   // only part of an index
+    };
+
+    QVector<int> matches;
+
+    for (WangId mask : masks) {
+        for (int n = 0; n < 200; ++n) {
+            WangId desired;
+            for (int i = 0; i < WangId::NumIndexes; ++i)
+                desired.setIndexColor(i, (n * 5 + i * 3 + n / 7) % 5);  // includes unused color 4
+
+            QVector<int> expected;
+            for (int i = 0; i < entries.size(); ++i)
+                if ((entries.at(i).wangId & mask) == (desired & mask))
+                    expected.append(i);
+
+            wangSet.findMatchingWangIds(desired, mask, matches);
+            QCOMPARE(matches, expected);
+            QCOMPARE(wangSet.wangIdIsUsed(desired, mask), !expected.isEmpty());
+        }
+    }
+}
+
+QTEST_MAIN(test_WangSet)
+#include "test_wangset.moc"